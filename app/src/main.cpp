@@ -26,6 +26,7 @@
 int main() {
     jerv::core::Jerver jerver;
     jerver.bindV4();
+    jerver.bindV6();
     jerver.start();
     return 0;
 }
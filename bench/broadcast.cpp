@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Fan-out of one chat message to 1, 20 and 200 connections. Sending it to each connection serializes, compresses and
+// copies it into every handoff ring, the broadcast path encodes one PreparedPayload and hands out references to it.
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "jerv/core/network/gameBatch.hpp"
+#include "jerv/protocol/packets/text.hpp"
+#include "jerv/raknet/serverConnection.hpp"
+
+namespace {
+    using namespace jerv;
+
+    constexpr size_t ROUNDS = 200;
+    constexpr core::network::CompressionSettings COMPRESSION{true, 256, 4};
+
+    struct Audience {
+        explicit Audience(const size_t size) : batches(size) {
+            for (size_t i = 0; i < size; i++) {
+                handoffs.push_back(std::make_unique<raknet::SpscRing<raknet::OutgoingFrame> >(
+                    raknet::OUTGOING_HANDOFF_CAPACITY));
+            }
+        }
+
+        // stands in for the network thread, which empties the rings between ticks
+        void drain() {
+            for (const auto &handoff: handoffs) {
+                const size_t count = handoff->readable();
+                for (size_t i = 0; i < count; i++) {
+                    handoff->peek(i).payload.reset();
+                }
+                handoff->pop(count);
+            }
+        }
+
+        std::vector<std::vector<uint8_t> > batches;
+        std::vector<std::unique_ptr<raknet::SpscRing<raknet::OutgoingFrame> > > handoffs;
+    };
+
+    void sendToEach(const protocol::PacketType &packet, Audience &audience) {
+        for (size_t i = 0; i < audience.handoffs.size(); i++) {
+            auto &batch = audience.batches[i];
+            core::network::appendGamePacket(batch, packet);
+            const auto framed = core::network::frameGameBatch(batch, COMPRESSION);
+
+            raknet::OutgoingFrame *frame = audience.handoffs[i]->claim();
+            frame->bytes.assign(framed.begin(), framed.end());
+            audience.handoffs[i]->publish();
+            batch.clear();
+        }
+    }
+
+    void broadcast(const protocol::PacketType &packet, Audience &audience) {
+        thread_local std::vector<uint8_t> batch;
+        batch.clear();
+        core::network::appendGamePacket(batch, packet);
+        const auto framed = core::network::frameGameBatch(batch, COMPRESSION);
+
+        auto payload = std::make_shared<raknet::PreparedPayload>();
+        payload->bytes.assign(framed.begin(), framed.end());
+        payload->ready.store(true, std::memory_order_release);
+
+        for (const auto &handoff: audience.handoffs) {
+            raknet::OutgoingFrame *frame = handoff->claim();
+            frame->payload = payload;
+            handoff->publish();
+        }
+    }
+
+    template<typename Fan>
+    double measure(const protocol::PacketType &packet, Audience &audience, Fan &&fan) {
+        fan(packet, audience);
+        audience.drain();
+
+        double total = 0;
+        for (size_t round = 0; round < ROUNDS; round++) {
+            const auto start = std::chrono::steady_clock::now();
+            fan(packet, audience);
+            total += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+            audience.drain();
+        }
+        return total / ROUNDS;
+    }
+}
+
+int main() {
+    protocol::TextPacket packet;
+    packet.contentType = protocol::TextContentType::AuthorAndMessage;
+    packet.messageType = static_cast<uint8_t>(protocol::TextTypeAuthorAndMessage::Chat);
+    packet.playerName = "Steve";
+    packet.message = std::string(300, 'a');
+
+    for (const size_t size: {1, 20, 200}) {
+        Audience audience(size);
+        const double each = measure(packet, audience, sendToEach);
+        const double shared = measure(packet, audience, broadcast);
+        std::printf("1 -> %3zu: send to each %8.1f us, broadcast %6.1f us\n", size, each, shared);
+    }
+}
@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Bytes and CPU per LevelChunk for the compression levels of the Zlib algorithm, once with the reused stream the send
+// path keeps per thread and once with a stream initialized for every chunk.
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "jerv/core/network/compression.hpp"
+#include "jerv/core/world/generator/chunk.hpp"
+
+namespace {
+    using namespace jerv::core;
+
+    constexpr size_t CHUNKS = 500;
+    constexpr int32_t STONE = 1;
+    constexpr int32_t DIRT = 2;
+    constexpr int32_t GRASS = 3;
+    constexpr int32_t ORE = 4;
+
+    // stone up to y 56 with a few ores, dirt and grass on top, air above, roughly what a plains chunk looks like
+    std::vector<uint8_t> serializeTerrainChunk() {
+        world::generator::Chunk chunk(0, 0);
+        std::mt19937 random(1);
+        for (int32_t x = 0; x < 16; x++) {
+            for (int32_t z = 0; z < 16; z++) {
+                for (int32_t y = world::generator::Chunk::OVERWORLD_MIN_Y; y < 60; y++) {
+                    int32_t state = y < 56 ? STONE : y < 59 ? DIRT : GRASS;
+                    if (state == STONE && random() % 50 == 0) {
+                        state = ORE;
+                    }
+                    chunk.setBlock(x, y, z, state);
+                }
+            }
+        }
+        return chunk.serialize().data;
+    }
+
+    void measure(const std::vector<uint8_t> &input, const int level, const bool reuseStream) {
+        network::Deflater reused(level);
+        std::vector<uint8_t> output;
+        size_t compressed = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < CHUNKS; i++) {
+            if (reuseStream) {
+                compressed = reused.compress(input, output, 0, level);
+            } else {
+                network::Deflater fresh(level);
+                compressed = fresh.compress(input, output, 0, level);
+            }
+        }
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+
+        std::printf("level %d %-6s %7zu -> %6zu bytes %8.1f us/chunk\n", level, reuseStream ? "reused" : "fresh",
+                    input.size(), compressed, elapsed.count() / CHUNKS);
+    }
+}
+
+int main() {
+    const auto input = serializeTerrainChunk();
+    for (const int level: {1, 4, 6, 9}) {
+        measure(input, level, true);
+        measure(input, level, false);
+    }
+}
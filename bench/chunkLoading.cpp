@@ -0,0 +1,152 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Chunk reads from a real world: 25 point lookups per chunk (the version key and every subchunk key, most of which do
+// not exist) against one prefix seek walking only the records that do, then LevelDB::readChunk including decoding.
+// Usage: bench_chunk_loading <world>/db [radius], chunks are read in the square of that radius around 0 0. Every
+// variant runs once unmeasured first, so all of them see the same warm page cache.
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "jerv/core/world/generator/levelDB.hpp"
+#include "leveldb/db.h"
+#include "leveldb/iterator.h"
+
+namespace {
+    using namespace jerv::core::world::generator;
+
+    constexpr uint8_t VERSION_TAG = 0x2c;
+    constexpr uint8_t SUB_CHUNK_PREFIX_TAG = 0x2f;
+    constexpr int32_t MIN_SUB_CHUNK_Y = -4;
+    constexpr int32_t MAX_SUB_CHUNK_Y = 19;
+
+    // overworld keys, the chunk position as two little endian int32 followed by the tag
+    std::array<char, 10> chunkKey(const int32_t x, const int32_t z) {
+        std::array<char, 10> key{};
+        std::memcpy(key.data(), &x, sizeof(x));
+        std::memcpy(key.data() + 4, &z, sizeof(z));
+        return key;
+    }
+
+    template<typename Read>
+    void measure(const char *name, const int32_t radius, Read &&read) {
+        size_t records = 0;
+        const auto pass = [&] {
+            for (int32_t x = -radius; x <= radius; x++) {
+                for (int32_t z = -radius; z <= radius; z++) {
+                    records += read(x, z);
+                }
+            }
+        };
+        pass();
+
+        records = 0;
+        const auto start = std::chrono::steady_clock::now();
+        pass();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double chunks = static_cast<double>((2 * radius + 1) * (2 * radius + 1));
+        std::printf("%-14s %10.0f chunks/s", name, chunks / seconds);
+        if (records > 0) {
+            std::printf(" %8zu records found", records);
+        }
+        std::printf("\n");
+    }
+
+    void measureRaw(const std::string &path, const int32_t radius) {
+        leveldb::DB *db = nullptr;
+        leveldb::Options options;
+        if (!leveldb::DB::Open(options, path, &db).ok()) {
+            std::printf("failed to open %s\n", path.c_str());
+            std::exit(1);
+        }
+        const leveldb::ReadOptions readOptions;
+
+        measure("point lookups", radius, [&](const int32_t x, const int32_t z) {
+            auto key = chunkKey(x, z);
+            key[8] = static_cast<char>(VERSION_TAG);
+            std::string value;
+            size_t found = db->Get(readOptions, leveldb::Slice(key.data(), 9), &value).ok();
+            for (int32_t y = MIN_SUB_CHUNK_Y; y <= MAX_SUB_CHUNK_Y; y++) {
+                key[8] = static_cast<char>(SUB_CHUNK_PREFIX_TAG);
+                key[9] = static_cast<char>(y);
+                found += db->Get(readOptions, leveldb::Slice(key.data(), key.size()), &value).ok();
+            }
+            return found;
+        });
+
+        {
+            const std::unique_ptr<leveldb::Iterator> iterator(db->NewIterator(readOptions));
+            measure("prefix scan", radius, [&](const int32_t x, const int32_t z) {
+                const auto key = chunkKey(x, z);
+                const leveldb::Slice prefix(key.data(), 8);
+                size_t found = 0;
+                for (iterator->Seek(prefix); iterator->Valid() && iterator->key().starts_with(prefix);
+                     iterator->Next()) {
+                    // same records the point lookups ask for, the scan also walks biomes, entities and the like
+                    const leveldb::Slice recordKey = iterator->key();
+                    found += (recordKey.size() == 9 && static_cast<uint8_t>(recordKey[8]) == VERSION_TAG) ||
+                            (recordKey.size() == 10 && static_cast<uint8_t>(recordKey[8]) == SUB_CHUNK_PREFIX_TAG);
+                }
+                return found;
+            });
+        }
+        delete db;
+    }
+
+    void measureReadChunk(const std::string &path, const int32_t radius) {
+        LevelDBOptions options;
+        options.path = path;
+        LevelDB world;
+        if (!world.open(options)) {
+            std::exit(1);
+        }
+
+        // readChunk keeps an iterator per thread, which has to go away before the database does
+        std::thread loader([&world, radius] {
+            measure("readChunk", radius, [&world](const int32_t x, const int32_t z) {
+                Chunk chunk(x, z);
+                world.readChunk(chunk);
+                return static_cast<size_t>(0);
+            });
+        });
+        loader.join();
+    }
+}
+
+int main(const int argc, char **argv) {
+    if (argc < 2) {
+        std::printf("usage: %s <world>/db [radius]\n", argv[0]);
+        return 1;
+    }
+    const std::string path = argv[1];
+    const int32_t radius = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    measureRaw(path, radius);
+    measureReadChunk(path, radius);
+}
@@ -0,0 +1,118 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Allocations and time per Jerver::send of a small packet. The previous path built three 512 KiB cursors and copied the
+// packet through each of them, the batched path appends into the reused batch of the connection and frames it in place.
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "jerv/binary/cursor.hpp"
+#include "jerv/core/network/gameBatch.hpp"
+#include "jerv/protocol/packets/playStatus.hpp"
+
+namespace {
+    std::atomic<size_t> allocations{0};
+
+    constexpr size_t WARMUP_SENDS = 100;
+
+    using namespace jerv;
+
+    // what Jerver::send did before the batch, minus the raknet frame copy both paths share
+    void sendThroughCursors(const protocol::PacketType &packet, std::vector<uint8_t> &frame) {
+        constexpr size_t maxSize = core::network::MAX_PACKET_BUFFER_SIZE + core::network::MAX_VARINT_SIZE * 2 + 2;
+
+        binary::ResizableCursor packetCursor(maxSize, maxSize);
+        packetCursor.writeVarInt32(static_cast<int32_t>(packet.getPacketId()));
+        packet.serialize(packetCursor);
+
+        binary::ResizableCursor gamePacketCursor(maxSize, maxSize);
+        gamePacketCursor.writeVarInt32(static_cast<int32_t>(packetCursor.getProcessedBytes().size()));
+        gamePacketCursor.writeSliceSpan(packetCursor.getProcessedBytes());
+
+        binary::ResizableCursor sendCursor(maxSize, maxSize);
+        // GameData id and the NoCompression marker
+        sendCursor.writeUint8(0xfe);
+        sendCursor.writeUint8(0xff);
+        sendCursor.writeSliceSpan(gamePacketCursor.getProcessedBytes());
+
+        const auto bytes = sendCursor.getProcessedBytes();
+        frame.assign(bytes.begin(), bytes.end());
+    }
+
+    void sendThroughBatch(const protocol::PacketType &packet, std::vector<uint8_t> &batch, std::vector<uint8_t> &frame) {
+        core::network::appendGamePacket(batch, packet);
+        const auto framed = core::network::frameGameBatch(batch, {true, 256, 4});
+        frame.assign(framed.begin(), framed.end());
+        batch.clear();
+    }
+
+    template<typename Send>
+    void measure(const char *name, const size_t sends, Send &&send) {
+        for (size_t i = 0; i < WARMUP_SENDS; i++) {
+            send();
+        }
+
+        const size_t before = allocations.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sends; i++) {
+            send();
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        const size_t counted = allocations.load(std::memory_order_relaxed) - before;
+
+        std::printf("%-8s %8.2f allocations/send %10.0f ns/send\n", name,
+                    static_cast<double>(counted) / static_cast<double>(sends),
+                    elapsed.count() / static_cast<double>(sends));
+    }
+}
+
+void *operator new(const size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+int main() {
+    protocol::PlayStatusPacket packet;
+    packet.status = protocol::PlayStatus::PlayerSpawn;
+
+    std::vector<uint8_t> batch;
+    std::vector<uint8_t> frame;
+    // the cursor path zeroes 1.5 MiB per send, a few thousand sends are plenty
+    measure("cursors", 2000, [&] { sendThroughCursors(packet, frame); });
+    measure("batch", 1000000, [&] { sendThroughBatch(packet, batch, frame); });
+}
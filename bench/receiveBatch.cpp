@@ -0,0 +1,105 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Loopback receive throughput of one recvfrom per datagram against ReceiveBatch draining up to RECEIVE_BATCH_SIZE per
+// recvmmsg call. Four sender threads keep the socket busy, so the numbers are what a single network thread can take in.
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "jerv/raknet/receiveBatch.hpp"
+
+namespace {
+    constexpr size_t SENDER_THREADS = 4;
+    constexpr size_t DATAGRAM_SIZE = 64;
+    constexpr std::chrono::seconds DURATION{2};
+
+    double measure(const bool batched) {
+        const int receiver = socket(AF_INET, SOCK_DGRAM, 0);
+        constexpr int receiveBufferSize = 16 * 1024 * 1024;
+        setsockopt(receiver, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize));
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(receiver, reinterpret_cast<sockaddr *>(&address), sizeof(address));
+        socklen_t addressSize = sizeof(address);
+        getsockname(receiver, reinterpret_cast<sockaddr *>(&address), &addressSize);
+
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> senders;
+        for (size_t i = 0; i < SENDER_THREADS; i++) {
+            senders.emplace_back([&stop, &address] {
+                const int sender = socket(AF_INET, SOCK_DGRAM, 0);
+                std::array<uint8_t, DATAGRAM_SIZE> datagram{0x84};
+                while (!stop.load(std::memory_order_relaxed)) {
+                    sendto(sender, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr *>(&address),
+                           sizeof(address));
+                }
+                close(sender);
+            });
+        }
+
+        jerv::raknet::ReceiveBatch batch;
+        std::vector<uint8_t> buffer(65536);
+        size_t received = 0;
+        const auto end = std::chrono::steady_clock::now() + DURATION;
+        while (std::chrono::steady_clock::now() < end) {
+            if (batched) {
+                received += batch.receive(receiver);
+            } else {
+                sockaddr_storage from{};
+                socklen_t fromSize = sizeof(from);
+                if (recvfrom(receiver, buffer.data(), buffer.size(), MSG_DONTWAIT, reinterpret_cast<sockaddr *>(&from),
+                             &fromSize) > 0) {
+                    received++;
+                }
+            }
+        }
+
+        stop.store(true, std::memory_order_relaxed);
+        for (auto &sender: senders) {
+            sender.join();
+        }
+        close(receiver);
+        return static_cast<double>(received) / static_cast<double>(DURATION.count());
+    }
+}
+
+int main() {
+    std::printf("recvfrom: %12.0f datagrams/s\n", measure(false));
+    std::printf("recvmmsg: %12.0f datagrams/s\n", measure(true));
+}
+#else
+#include <cstdio>
+
+int main() {
+    std::printf("the batched receive path is Linux only\n");
+}
+#endif
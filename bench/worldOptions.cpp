@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Point lookups of every subchunk key of a chunk, most of which miss, under different LevelDBOptions. A bloom filter
+// answers a miss without reading the data block, but only for tables written while the same policy was set, so a world
+// the game wrote may show no difference until LevelDB compacts it with the filter on.
+// Usage: bench_world_options <world>/db [radius]
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "jerv/core/world/generator/levelDB.hpp"
+#include "leveldb/db.h"
+
+namespace {
+    using namespace jerv::core::world::generator;
+
+    constexpr uint8_t SUB_CHUNK_PREFIX_TAG = 0x2f;
+    constexpr int32_t MIN_SUB_CHUNK_Y = -4;
+    constexpr int32_t MAX_SUB_CHUNK_Y = 19;
+
+    struct Variant {
+        const char *name;
+        LevelDBOptions options;
+    };
+
+    void measure(const std::string &path, const int32_t radius, const Variant &variant) {
+        const LevelDBSettings settings(variant.options);
+        const leveldb::ReadOptions &readOptions = settings.readOptions;
+
+        leveldb::DB *db = nullptr;
+        if (!leveldb::DB::Open(settings.dbOptions, path, &db).ok()) {
+            std::printf("failed to open %s\n", path.c_str());
+            std::exit(1);
+        }
+
+        size_t lookups = 0;
+        size_t found = 0;
+        std::string value;
+        const auto pass = [&] {
+            for (int32_t x = -radius; x <= radius; x++) {
+                for (int32_t z = -radius; z <= radius; z++) {
+                    std::array<char, 10> key{};
+                    std::memcpy(key.data(), &x, sizeof(x));
+                    std::memcpy(key.data() + 4, &z, sizeof(z));
+                    key[8] = static_cast<char>(SUB_CHUNK_PREFIX_TAG);
+                    for (int32_t y = MIN_SUB_CHUNK_Y; y <= MAX_SUB_CHUNK_Y; y++) {
+                        key[9] = static_cast<char>(y);
+                        found += db->Get(readOptions, leveldb::Slice(key.data(), key.size()), &value).ok();
+                        lookups++;
+                    }
+                }
+            }
+        };
+
+        // the first pass fills the block cache, the second one shows what a cache of that size keeps
+        pass();
+        lookups = 0;
+        found = 0;
+        const auto start = std::chrono::steady_clock::now();
+        pass();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-22s %10.0f lookups/s %6.1f%% missed\n", variant.name, static_cast<double>(lookups) / seconds,
+                    100.0 * static_cast<double>(lookups - found) / static_cast<double>(lookups));
+        delete db;
+    }
+}
+
+int main(const int argc, char **argv) {
+    if (argc < 2) {
+        std::printf("usage: %s <world>/db [radius]\n", argv[0]);
+        return 1;
+    }
+    const std::string path = argv[1];
+    const int32_t radius = argc > 2 ? std::atoi(argv[2]) : 16;
+
+    LevelDBOptions defaults;
+    LevelDBOptions noFilter = defaults;
+    noFilter.bloomFilterBitsPerKey = 0;
+    LevelDBOptions smallCache = defaults;
+    smallCache.blockCacheCapacity = 0;
+    LevelDBOptions noFill = defaults;
+    noFill.fillCache = false;
+    LevelDBOptions checksums = defaults;
+    checksums.verifyChecksums = true;
+
+    for (const Variant &variant: {
+             Variant{"defaults", defaults},
+             Variant{"no bloom filter", noFilter},
+             Variant{"8 MiB block cache", smallCache},
+             Variant{"no fill cache", noFill},
+             Variant{"verify checksums", checksums}
+         }) {
+        measure(path, radius, variant);
+    }
+}
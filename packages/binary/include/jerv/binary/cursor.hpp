@@ -35,10 +35,16 @@
 #include "jerv/common/logger.hpp"
 
 namespace jerv::binary {
+    // raknet puts the windows value of AF_INET6 on the wire, regardless of the platform
+    constexpr uint16_t ADDRESS_FAMILY_INET6 = 23;
+
     struct Address {
         uint8_t family;
         uint32_t ip;
         uint16_t port;
+        std::array<uint8_t, 16> ip6{};
+        uint32_t flowInfo = 0;
+        uint32_t scopeId = 0;
 
         std::array<uint8_t, 4> toBytes() const {
             return {
@@ -467,6 +473,17 @@ namespace jerv::binary {
             }
         }
 
+        // number of bytes writeVarInt32 takes for the value
+        static size_t varInt32Size(const int32_t value) {
+            auto uvalue = static_cast<uint32_t>(value);
+            size_t size = 1;
+            while ((uvalue & ~0x7F) != 0) {
+                uvalue >>= 7;
+                size++;
+            }
+            return size;
+        }
+
         void writeVarInt64(const int64_t value) {
             auto uvalue = static_cast<uint64_t>(value);
             for (int i = 0; i < 10; i++) {
@@ -490,6 +507,17 @@ namespace jerv::binary {
         Address readAddress() {
             Address address{};
             address.family = readUint8();
+
+            if (address.family == 6) {
+                readUint16<true>(); // address family
+                address.port = readUint16();
+                address.flowInfo = readUint32();
+                const auto ip6 = readSliceSpan(address.ip6.size());
+                std::memcpy(address.ip6.data(), ip6.data(), ip6.size());
+                address.scopeId = readUint32();
+                return address;
+            }
+
             address.ip = readUint32();
             address.port = readUint16();
 
@@ -498,6 +526,16 @@ namespace jerv::binary {
 
         void writeAddress(const Address &address) {
             writeUint8(address.family);
+
+            if (address.family == 6) {
+                writeUint16<true>(ADDRESS_FAMILY_INET6);
+                writeUint16(address.port);
+                writeUint32(address.flowInfo);
+                writeSliceSpan(address.ip6);
+                writeUint32(address.scopeId);
+                return;
+            }
+
             writeUint32(address.ip);
             writeUint16(address.port);
         }
@@ -154,7 +154,68 @@ namespace jerv::binary {
             return reader(*this, static_cast<NBTDataType>(type));
         }
 
+        /**
+         * @brief Moves past the next named tag without building it, for callers that only need its raw bytes
+         */
+        void skip() {
+            const auto type = static_cast<NBTDataType>(cursor.readUint8());
+            if (type == NBTDataType::EndOfCompound) {
+                return;
+            }
+            cursor.readSliceSpan(cursor.readUint16<true>());
+            skipPayload(type);
+        }
+
     private:
+        void skipPayload(const NBTDataType type) {
+            switch (type) {
+                case EndOfCompound:
+                    break;
+                case Int8:
+                    cursor.readSliceSpan(1);
+                    break;
+                case Int16:
+                    cursor.readSliceSpan(2);
+                    break;
+                case Int32:
+                case Float:
+                    cursor.readSliceSpan(4);
+                    break;
+                case Int64:
+                case Double:
+                    cursor.readSliceSpan(8);
+                    break;
+                case Int8List:
+                    cursor.readSliceSpan(cursor.readUint32<true>());
+                    break;
+                case String:
+                    cursor.readSliceSpan(cursor.readUint16<true>());
+                    break;
+                case List: {
+                    const auto listType = static_cast<NBTDataType>(cursor.readUint8());
+                    const int32_t size = cursor.readInt32<true>();
+                    for (int32_t i = 0; i < size; ++i) {
+                        skipPayload(listType);
+                    }
+                    break;
+                }
+                case Compound:
+                    while (true) {
+                        const auto childType = static_cast<NBTDataType>(cursor.readUint8());
+                        if (childType == NBTDataType::EndOfCompound) break;
+                        cursor.readSliceSpan(cursor.readUint16<true>());
+                        skipPayload(childType);
+                    }
+                    break;
+                case Int32List:
+                    cursor.readSliceSpan(static_cast<size_t>(cursor.readUint32<true>()) * 4);
+                    break;
+                case Int64List:
+                    cursor.readSliceSpan(static_cast<size_t>(cursor.readUint32<true>()) * 8);
+                    break;
+            }
+        }
+
         using ReaderFn = NBTData(*)(NBT &, NBTDataType);
 
         static ReaderFn getReader(NBTDataType type) {
@@ -23,25 +23,102 @@
 
 #pragma once
 #include "jerv/raknet/raknetServer.hpp"
+#include "network/gameBatch.hpp"
 #include "tick/tickManager.hpp"
 #include "world/dimension.hpp"
+#include "workerPool.hpp"
 
 namespace jerv::core {
     class Jerver {
     public:
         Jerver();
 
+        void setNetworkThreads(size_t count);
+
+        /**
+         * @brief Sets how many threads serialize and compress chunks, has to be called before start
+         */
+        void setChunkWorkerThreads(size_t count);
+
+        /**
+         * @brief Sets how many threads read chunks from the world, has to be called before start
+         */
+        void setChunkLoaderThreads(size_t count);
+
+        /**
+         * @brief Sets the world database to load chunks from and how it is cached, has to be called before start
+         */
+        void setWorldOptions(world::generator::LevelDBOptions options);
+
         void bindV4(uint16_t port = raknet::NETWORK_LAN_DISCOVERY_PORT4);
 
         void bindV6(uint16_t port = raknet::NETWORK_LAN_DISCOVERY_PORT6);
 
         void start();
 
+        /**
+         * @brief MSPT, TPS and per phase tick times as of the last profiler report
+         */
+        tick::TickStatistics tickStatistics() const {
+            return tickManager.profiler().statistics();
+        }
+
+        /**
+         * @brief Appends the packet to the game packet batch of the connection, which goes out on flush.
+         * Sending is for the tick thread, handlers and tick callbacks already run there.
+         */
         void send(raknet::ServerConnection &connection, const protocol::PacketType &packet);
 
+        /**
+         * @brief Hands the packets batched for the connection to its network thread as one GameData frame
+         */
+        void flush(raknet::ServerConnection &connection);
+
+        /**
+         * @brief Serializes and compresses the packet once and queues the same buffer for every connection.
+         * The audience has to stay connected for the call, collect it inside forEachConnection or a handler.
+         */
+        void broadcast(const protocol::PacketType &packet, std::span<raknet::ServerConnection *const> audience);
+
+        /**
+         * @brief Builds the join sequence batch again, call after anything it contains like items or commands changed
+         */
+        void rebuildJoinSequence();
+
+        void sendJoinSequence(raknet::ServerConnection &connection);
+
+        /**
+         * @brief Batches of at least this many bytes are sent zlib compressed, has to be set before clients join
+         */
+        void setCompressionThreshold(uint16_t threshold);
+
+        void setCompressionLevel(int level);
+
+        uint16_t getCompressionThreshold() const {
+            return compressionThreshold;
+        }
+
+        static constexpr uint16_t DEFAULT_COMPRESSION_THRESHOLD = 256;
+        static constexpr int DEFAULT_COMPRESSION_LEVEL = 4;
+
+        // batches are flushed early once they grow past this, so a single frame does not fragment endlessly
+        static constexpr size_t GAME_PACKET_BATCH_FLUSH_SIZE = 65536;
+
     private:
+        // decompressed inbound batches larger than this are dropped
+        static constexpr size_t MAX_INBOUND_BATCH_SIZE = 2 * 1024 * 1024;
+
+        // a client with more than this waiting for the tick thread is disconnected, so a flood cannot grow memory
+        static constexpr size_t MAX_INBOUND_QUEUED_BYTES = 4 * 1024 * 1024;
+
+        // handoff slots that grew past this for a large batch give the memory back once it is handled
+        static constexpr size_t INBOUND_RETAINED_CAPACITY = 2048;
+
+        // network thread side, only copies the batch into a handoff slot of the connection
         static void handleDataStatic(void *ctx, raknet::ServerConnection &connection, std::span<uint8_t> data);
 
+        void drainInbound(raknet::ServerConnection &connection);
+
         void handleData(raknet::ServerConnection &connection, std::span<uint8_t> data);
 
         void handlePacket(raknet::ServerConnection &connection, std::span<uint8_t> data);
@@ -50,8 +127,40 @@ namespace jerv::core {
 
         void handleTick(uint64_t tick);
 
+        void tickConnection(raknet::ServerConnection &connection);
+
+        network::CompressionSettings compressionFor(const raknet::ServerConnection &connection) const;
+
+        void encodePacket(const protocol::PacketType &packet, raknet::PreparedPayload &payload) const;
+
+        void prepareBatch(std::vector<uint8_t> &batch, raknet::PreparedPayload &payload) const;
+
+        // hands the payload over right away when it is ready and nothing is queued before it, queues it otherwise
+        void queuePreparedPayload(raknet::ServerConnection &connection,
+                                  std::shared_ptr<raknet::PreparedPayload> payload);
+
+        void sendPreparedPayloads(raknet::ServerConnection &connection);
+
+        static constexpr uint64_t CHUNK_WORKER_REPORT_INTERVAL = 100;
+
         raknet::RaknetServer raknetServer;
         tick::TickManager tickManager;
+        tick::TickProfiler::PhaseId inboundPhase;
+        tick::TickProfiler::PhaseId chunkGenerationPhase;
+        tick::TickProfiler::PhaseId sendingPhase;
         world::Dimension dimension{"overworld"};
+
+        uint16_t compressionThreshold = DEFAULT_COMPRESSION_THRESHOLD;
+        int compressionLevel = DEFAULT_COMPRESSION_LEVEL;
+
+        std::shared_ptr<raknet::PreparedPayload> joinSequence;
+        std::mutex joinSequenceMutex;
+
+        size_t chunkWorkerThreads = std::max<size_t>(std::thread::hardware_concurrency() / 2, 1);
+        WorkerPool chunkWorkers;
+
+        // loading is disk bound, a couple of threads keep enough reads in flight
+        size_t chunkLoaderThreads = 2;
+        world::generator::LevelDBOptions worldOptions;
     };
 }
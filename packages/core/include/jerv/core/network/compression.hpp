@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <zlib.h>
+
+namespace jerv::core::network {
+    /**
+     * @brief Raw deflate stream, as used by the Zlib compression algorithm of the bedrock protocol.
+     * The stream is reset between batches instead of being initialized again, keep one per thread.
+     */
+    class Deflater {
+    public:
+        explicit Deflater(int level);
+
+        ~Deflater();
+
+        Deflater(const Deflater &) = delete;
+
+        Deflater &operator=(const Deflater &) = delete;
+
+        /**
+         * @brief Compresses input into output after the first offset bytes, growing output when it is too small
+         * @return the number of compressed bytes, 0 if deflate failed
+         */
+        size_t compress(std::span<const uint8_t> input, std::vector<uint8_t> &output, size_t offset, int level);
+
+    private:
+        z_stream stream{};
+        int currentLevel;
+    };
+
+    /**
+     * @brief Raw inflate stream with a hard cap on the output size, so a small batch can not expand without bound.
+     * Like Deflater it is reset between batches, keep one per thread.
+     */
+    class Inflater {
+    public:
+        Inflater();
+
+        ~Inflater();
+
+        Inflater(const Inflater &) = delete;
+
+        Inflater &operator=(const Inflater &) = delete;
+
+        /**
+         * @brief Decompresses input into output, growing output up to maxSize bytes
+         * @return the number of decompressed bytes, std::nullopt if the input is corrupt or expands past maxSize
+         */
+        std::optional<size_t> decompress(std::span<const uint8_t> input, std::vector<uint8_t> &output,
+                                         size_t maxSize);
+
+    private:
+        z_stream stream{};
+    };
+}
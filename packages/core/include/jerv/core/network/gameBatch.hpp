@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "jerv/protocol/packet.hpp"
+
+namespace jerv::core::network {
+    constexpr size_t MAX_PACKET_BUFFER_SIZE = 524288;
+    constexpr size_t MAX_VARINT_SIZE = 5;
+    // GameData id and compression byte in front of every batch
+    constexpr size_t GAME_BATCH_HEADER_SIZE = 2;
+
+    struct CompressionSettings {
+        // the compression byte is only sent once NetworkSettings went out
+        bool enabled = false;
+        uint16_t threshold = 0;
+        int level = 0;
+    };
+
+    /**
+     * @brief Serializes the packet once and appends it length-prefixed to the batch, reserving the header if empty
+     */
+    void appendGamePacket(std::vector<uint8_t> &batch, const protocol::PacketType &packet);
+
+    /**
+     * @brief Fills in the header of the batch and compresses it when it reaches the threshold.
+     * The returned span points either into the batch or into a buffer of the calling thread, which stays valid until
+     * the next call on that thread.
+     */
+    std::span<uint8_t> frameGameBatch(std::vector<uint8_t> &batch, const CompressionSettings &compression);
+}
@@ -27,6 +27,8 @@
 #include <atomic>
 #include <thread>
 
+#include "tickProfiler.hpp"
+
 namespace jerv::core::tick {
     class TickManager {
     public:
@@ -39,6 +41,15 @@ namespace jerv::core::tick {
         void setTicksPerSecond(int tps);
 
         uint64_t currentTick = 0;
+        std::chrono::steady_clock::duration lastTickDuration{};
+
+        TickProfiler &profiler() {
+            return tickProfiler;
+        }
+
+        const TickProfiler &profiler() const {
+            return tickProfiler;
+        }
 
         using Callback = void(*)(void*, uint64_t);
         void setCallback(void* ctx, const Callback cb) {
@@ -48,7 +59,8 @@ namespace jerv::core::tick {
     private:
         void run();
 
-        std::chrono::steady_clock::time_point currentTickStartTime;
+        TickProfiler tickProfiler;
+
         int ticksPerSecond = 20;
         std::chrono::duration<double> interval{1.0 / ticksPerSecond};
 
@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace jerv::core::tick {
+    // all times in milliseconds
+    struct PhaseStatistics {
+        std::string name;
+        double p50 = 0;
+        double p99 = 0;
+        double max = 0;
+    };
+
+    struct TickStatistics {
+        double mspt = 0;
+        double tps = 0;
+        PhaseStatistics tick;
+        std::vector<PhaseStatistics> phases;
+    };
+
+    /**
+     * @brief Times every tick and the named phases inside it over a rolling window of the last WINDOW_TICKS ticks.
+     * Everything except statistics() belongs to the tick thread.
+     */
+    class TickProfiler {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using PhaseId = size_t;
+
+        // adds the time until it goes out of scope to the phase, a phase can be measured any number of times per tick
+        class Scope {
+        public:
+            Scope(TickProfiler &profiler, const PhaseId phase) : profiler(profiler), phase(phase),
+                                                                 start(Clock::now()) {
+            }
+
+            ~Scope() {
+                profiler.addPhaseTime(phase, Clock::now() - start);
+            }
+
+            Scope(const Scope &) = delete;
+
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            TickProfiler &profiler;
+            PhaseId phase;
+            Clock::time_point start;
+        };
+
+        /**
+         * @brief Adds a phase to the profile, has to be called before the tick thread starts
+         */
+        PhaseId registerPhase(std::string name);
+
+        Scope measure(const PhaseId phase) {
+            return {*this, phase};
+        }
+
+        void addPhaseTime(PhaseId phase, Clock::duration duration);
+
+        void beginTick(uint64_t tick);
+
+        /**
+         * @brief Records the tick, warns with a per phase breakdown when it went over budget
+         * and logs the statistics every REPORT_INTERVAL ticks
+         * @return how long the tick took
+         */
+        Clock::duration endTick(Clock::duration budget);
+
+        /**
+         * @brief Statistics as of the last report, safe to call from any thread
+         */
+        TickStatistics statistics() const;
+
+        // a minute at 20 TPS
+        static constexpr size_t WINDOW_TICKS = 1200;
+        static constexpr uint64_t REPORT_INTERVAL = 100;
+
+    private:
+        struct Phase {
+            std::string name;
+            Clock::duration current{};
+            std::vector<Clock::duration> samples = std::vector<Clock::duration>(WINDOW_TICKS);
+        };
+
+        PhaseStatistics summarize(const std::string &name, const std::vector<Clock::duration> &samples);
+
+        void warnOverrun(Clock::duration duration, Clock::duration budget) const;
+
+        void report();
+
+        std::vector<Phase> phases;
+        std::vector<Clock::duration> tickSamples = std::vector<Clock::duration>(WINDOW_TICKS);
+        std::vector<Clock::time_point> tickStarts = std::vector<Clock::time_point>(WINDOW_TICKS);
+        // reused by summarize, so reports do not allocate
+        std::vector<Clock::duration> sortScratch;
+        // ticks recorded so far, the next sample goes to recorded % WINDOW_TICKS
+        uint64_t recorded = 0;
+
+        uint64_t currentTick = 0;
+        Clock::time_point currentTickStart;
+
+        TickStatistics lastReport;
+        mutable std::mutex lastReportMutex;
+    };
+}
@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jerv::core {
+    /**
+     * @brief Fixed set of threads working off a shared FIFO of jobs, for work that should stay off the tick thread
+     */
+    class WorkerPool {
+    public:
+        using Job = std::function<void()>;
+
+        WorkerPool() = default;
+
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool &) = delete;
+
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void start(size_t threadCount);
+
+        // finishes the queued jobs, then joins the threads
+        void stop();
+
+        void submit(Job job);
+
+        size_t queuedJobs() const;
+
+    private:
+        void run();
+
+        std::vector<std::thread> threads;
+        std::deque<Job> jobs;
+        mutable std::mutex jobsMutex;
+        std::condition_variable jobsAvailable;
+        bool stopping = false;
+    };
+}
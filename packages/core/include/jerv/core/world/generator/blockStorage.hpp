@@ -37,6 +37,12 @@ namespace jerv::core::world::generator {
 
         BlockStorage();
 
+        /**
+         * @brief Takes over an already decoded palette and MAX_SIZE palette indices in x, z, y order
+         * @throws std::invalid_argument if the palette is empty or there aren't exactly MAX_SIZE indices
+         */
+        BlockStorage(std::vector<int32_t> palette, std::vector<uint16_t> blocks);
+
         bool isEmpty();
 
         int32_t getState(int32_t x, int32_t y, int32_t z);
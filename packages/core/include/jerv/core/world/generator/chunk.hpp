@@ -22,9 +22,13 @@
  */
 
 #pragma once
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <shared_mutex>
 
 #include "subChunk.hpp"
+#include "jerv/raknet/preparedPayload.hpp"
 #include "jerv/protocol/enums.hpp"
 #include "jerv/protocol/packets/levelChunk.hpp"
 
@@ -74,11 +78,36 @@ namespace jerv::core::world::generator {
 
         void setBlock(int32_t x, int32_t y, int32_t z, int32_t state, size_t layer = 0);
 
+        // replaces a whole layer of the subchunk at subChunkY (y >> 4) at once, for bulk loading
+        void setSubChunkLayer(int32_t subChunkY, size_t layer, BlockStorage storage);
+
+        // drops every subchunk, leaving only air
+        void clear();
+
         protocol::LevelChunkPacket serialize();
 
+        /**
+         * @brief Framed and compressed LevelChunk shared by every viewer until the chunk changes.
+         * The bool is true for the caller that created the payload, which then has to get it encoded.
+         */
+        std::pair<std::shared_ptr<raknet::PreparedPayload>, bool> acquirePayload();
+
+        // drops the shared payload, viewers that already queued it still send the old one
+        void setDirty();
+
+        // false while a loader fills the chunk in, the tick thread must not touch it before that
+        bool isLoaded() const {
+            return loaded.load(std::memory_order_acquire);
+        }
+
+        void markLoaded() {
+            loaded.store(true, std::memory_order_release);
+        }
+
         int32_t chunkX;
         int32_t chunkZ;
 
+        // connections that were sent the chunk or are waiting for it to load
         uint16_t viewers = 0;
     private:
         int32_t getSubChunkSendCount();
@@ -96,6 +125,13 @@ namespace jerv::core::world::generator {
         int32_t minY;
         int32_t maxY;
 
-        std::optional<protocol::LevelChunkPacket> cache;
+        // only touched on the tick thread, workers just fill in the payload they were handed
+        std::shared_ptr<raknet::PreparedPayload> payload;
+
+        std::atomic<bool> loaded{false};
+
+        // serialize reads the blocks on chunk workers while the tick thread may write them, reads on the tick thread
+        // need no lock since it is the only writer
+        std::shared_mutex blocksMutex;
     };
 }
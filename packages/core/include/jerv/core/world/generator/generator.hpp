@@ -22,25 +22,51 @@
  */
 
 #pragma once
+#include <memory>
 #include <vector>
 
 #include "chunk.hpp"
 #include "jerv/raknet/serverConnection.hpp"
+#include "jerv/core/workerPool.hpp"
 #include "jerv/core/world/generator/levelDB.hpp"
 
 namespace jerv::core::world::generator {
     class ChunkGenerator {
     public:
-        std::pair<std::vector<protocol::ChunkCoords>, std::vector<Chunk *> > generateChunks(raknet::ServerConnection &connection
-        );
+        /**
+         * @brief Starts the threads that read chunks from the world, has to be called before the first tick
+         */
+        void startLoading(size_t threadCount);
 
-        Chunk *generateChunk(int32_t chunkX, int32_t chunkZ, uint64_t chunkKey);
+        bool openWorld(const LevelDBOptions &options) {
+            return levelDB.open(options);
+        }
+
+        size_t queuedLoads() const {
+            return loaders.queuedJobs();
+        }
+
+        /**
+         * @brief Picks the next chunks to send around the player, only chunks that finished loading are returned.
+         * Missing chunks nearest to the player are queued for loading and show up on a later call.
+         */
+        std::pair<std::vector<protocol::ChunkCoords>, std::vector<std::shared_ptr<Chunk> > > generateChunks(
+            raknet::ServerConnection &connection);
+
+        // returns the chunk right away, a new chunk is loaded on a loader thread and stays unloaded until that is done
+        std::shared_ptr<Chunk> generateChunk(int32_t chunkX, int32_t chunkZ, uint64_t chunkKey);
 
         uint64_t getChunkKey(int32_t chunkX, int32_t chunkZ);
 
     private:
-        std::unordered_map<uint64_t, Chunk> chunks;
+        // drops one viewer of the chunk and unloads it once nobody views it anymore
+        void releaseChunk(uint64_t chunkKey);
+
+        // shared so chunks that are still being encoded on a worker outlive their unload
+        std::unordered_map<uint64_t, std::shared_ptr<Chunk> > chunks;
 
         LevelDB levelDB;
+        // declared after levelDB, so it finishes the queued loads before the database closes
+        WorkerPool loaders;
     };
 }
@@ -23,17 +23,98 @@
 
 #pragma once
 
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
 #include "chunk.hpp"
+#include "leveldb/cache.h"
 #include "leveldb/db.h"
+#include "leveldb/filter_policy.h"
+#include "leveldb/iterator.h"
 
 namespace jerv::core::world::generator {
+    struct LevelDBOptions {
+        // relative to the working directory, the LevelDB of a Bedrock world folder is its db directory
+        std::string path = "worlds/world/db";
+        size_t blockSize = 64 * 1024;
+        // LRU cache of uncompressed blocks, 0 keeps the 8 MiB default of LevelDB
+        size_t blockCacheCapacity = 32 * 1024 * 1024;
+        // only helps point lookups on tables written with the same policy, 0 disables it
+        int bloomFilterBitsPerKey = 10;
+        // neighbouring chunks usually share a block, turn off when loading a lot of chunks once
+        bool fillCache = true;
+        bool verifyChecksums = false;
+    };
+
+    /**
+     * @brief The LevelDB options a LevelDBOptions translates to, owning the cache and filter policy they point to.
+     * Has to outlive the database opened with it.
+     */
+    struct LevelDBSettings {
+        LevelDBSettings() = default;
+
+        explicit LevelDBSettings(const LevelDBOptions &options);
+
+        std::unique_ptr<leveldb::Cache> blockCache;
+        std::unique_ptr<const leveldb::FilterPolicy> filterPolicy;
+        leveldb::Options dbOptions;
+        leveldb::ReadOptions readOptions;
+    };
+
     class LevelDB {
     public:
-        LevelDB();
+        LevelDB() = default;
+
+        ~LevelDB();
+
+        LevelDB(const LevelDB &) = delete;
+
+        LevelDB &operator=(const LevelDB &) = delete;
+
+        /**
+         * @brief Opens the world database, chunks read before or after a failed open stay empty
+         */
+        bool open(const LevelDBOptions &options);
 
         Chunk &readChunk(Chunk &chunk);
 
     private:
+        static constexpr size_t CHUNK_KEY_PREFIX_SIZE = 8;
+        static constexpr uint8_t VERSION_TAG = 0x2c;
+        static constexpr uint8_t SUB_CHUNK_PREFIX_TAG = 0x2f;
+        static constexpr int32_t MIN_SUB_CHUNK_Y = -4;
+        static constexpr int32_t MAX_SUB_CHUNK_Y = 19;
+
+        leveldb::Iterator &iteratorForThread();
+
+        static bool isValidBitsPerBlock(uint8_t bitsPerBlock);
+
+        // decodes one SubChunkPrefix record into the chunk, throws on a storage that can't be valid
+        void readSubChunk(Chunk &chunk, int32_t subChunkY, std::span<uint8_t> data);
+
+        // network hash of a serialized palette entry, each distinct entry is only parsed and hashed once
+        int32_t blockStateHash(std::span<uint8_t> entry);
+
+        static int32_t computeBlockStateHash(std::span<uint8_t> entry);
+
+        struct RawEntryHash {
+            using is_transparent = void;
+
+            size_t operator()(const std::string_view bytes) const {
+                return std::hash<std::string_view>{}(bytes);
+            }
+        };
+
+        // keyed by the raw entry bytes, shared by all loader threads and kept for the lifetime of the world
+        std::unordered_map<std::string, int32_t, RawEntryHash, std::equal_to<> > blockStateHashes;
+        std::shared_mutex blockStateHashesMutex;
+
+        // the database has to close before the cache and filter policy it uses go away
+        LevelDBSettings settings;
         leveldb::DB *db = nullptr;
     };
 }
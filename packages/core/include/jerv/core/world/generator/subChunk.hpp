@@ -34,6 +34,8 @@ namespace jerv::core::world::generator {
 
         BlockStorage& getLayer(size_t index = 0);
 
+        void setLayer(size_t index, BlockStorage storage);
+
         int32_t getState(int32_t x, int32_t y, int32_t z, size_t layer = 0);
 
         void setState(int32_t x, int32_t y, int32_t z, int32_t state, size_t layer = 0);
@@ -33,11 +33,13 @@ namespace jerv::core::handler {
         requestNetworkSettings.deserialize(cursor);
 
         protocol::NetworkSettingsPacket networkSettings;
-        networkSettings.compressionAlgorithm = protocol::CompressionAlgorithm::NoCompression;
-        networkSettings.compressionThreshold = 0;
+        networkSettings.compressionAlgorithm = protocol::CompressionAlgorithm::Zlib;
+        networkSettings.compressionThreshold = server.getCompressionThreshold();
         networkSettings.clientThrottleEnabled = false;
 
         server.send(connection, networkSettings);
+        // NetworkSettings itself still goes out without the compression byte
+        server.flush(connection);
         connection.networkSettingsSent = true;
     }
 
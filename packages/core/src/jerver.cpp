@@ -24,6 +24,9 @@
 #include "jerv/core/jerver.hpp"
 
 #include "jerv/common/logger.hpp"
+#include "jerv/core/network/compression.hpp"
+#include "jerv/core/joinSequence.hpp"
+#include "jerv/core/network/gameBatch.hpp"
 #include "jerv/protocol/packets/networkSettings.hpp"
 
 #include "jerv/core/packetHandler.hpp"
@@ -31,6 +34,34 @@
 
 namespace jerv::core {
     Jerver::Jerver() {
+        auto &profiler = tickManager.profiler();
+        inboundPhase = profiler.registerPhase("inbound");
+        chunkGenerationPhase = profiler.registerPhase("chunk generation");
+        sendingPhase = profiler.registerPhase("sending");
+    }
+
+    void Jerver::setNetworkThreads(const size_t count) {
+        raknetServer.setShardCount(count);
+    }
+
+    void Jerver::setCompressionThreshold(const uint16_t threshold) {
+        compressionThreshold = threshold;
+    }
+
+    void Jerver::setChunkWorkerThreads(const size_t count) {
+        chunkWorkerThreads = std::max<size_t>(count, 1);
+    }
+
+    void Jerver::setChunkLoaderThreads(const size_t count) {
+        chunkLoaderThreads = std::max<size_t>(count, 1);
+    }
+
+    void Jerver::setWorldOptions(world::generator::LevelDBOptions options) {
+        worldOptions = std::move(options);
+    }
+
+    void Jerver::setCompressionLevel(const int level) {
+        compressionLevel = std::clamp(level, Z_NO_COMPRESSION, Z_BEST_COMPRESSION);
     }
 
     void Jerver::bindV4(const uint16_t port) {
@@ -42,6 +73,11 @@ namespace jerv::core {
     }
 
     void Jerver::start() {
+        chunkWorkers.start(chunkWorkerThreads);
+        dimension.generator.openWorld(worldOptions);
+        dimension.generator.startLoading(chunkLoaderThreads);
+        rebuildJoinSequence();
+
         tickManager.setCallback(this, &handleTickStatic);
         tickManager.start();
 
@@ -50,7 +86,38 @@ namespace jerv::core {
     }
 
     void Jerver::handleDataStatic(void *ctx, raknet::ServerConnection &connection, const std::span<uint8_t> data) {
-        static_cast<Jerver *>(ctx)->handleData(connection, data);
+        // GameData is handled on the tick thread, so game state has a single writer
+        std::vector<uint8_t> *slot = connection.incomingHandoff.claim();
+        if (!slot || connection.incomingHandoffBytes.load(std::memory_order_relaxed) + data.size() >
+                     MAX_INBOUND_QUEUED_BYTES) {
+            // the player name belongs to the tick thread, the endpoint never changes after the connection is made
+            JERV_LOG_WARN("disconnecting {}:{}, it sends faster than the tick handles",
+                          connection.endpoint.address().to_string(), connection.endpoint.port());
+            static_cast<Jerver *>(ctx)->raknetServer.disconnectClient(connection);
+            return;
+        }
+        slot->assign(data.begin(), data.end());
+        connection.incomingHandoffBytes.fetch_add(data.size(), std::memory_order_relaxed);
+        connection.incomingHandoff.publish();
+    }
+
+    void Jerver::drainInbound(raknet::ServerConnection &connection) {
+        auto &handoff = connection.incomingHandoff;
+        const size_t count = handoff.readable();
+        size_t bytes = 0;
+        for (size_t i = 0; i < count; i++) {
+            std::vector<uint8_t> &batch = handoff.peek(i);
+            bytes += batch.size();
+            // whatever was still queued from a disconnected client is dropped
+            if (!connection.closed.load(std::memory_order_acquire)) {
+                handleData(connection, batch);
+            }
+            if (batch.capacity() > INBOUND_RETAINED_CAPACITY) {
+                std::vector<uint8_t>().swap(batch);
+            }
+        }
+        handoff.pop(count);
+        connection.incomingHandoffBytes.fetch_sub(bytes, std::memory_order_relaxed);
     }
 
     void Jerver::handleTickStatic(void *ctx, const uint64_t tick) {
@@ -58,38 +125,85 @@ namespace jerv::core {
     }
 
     void Jerver::handleTick(const uint64_t tick) {
-        // TODO: loop causes segfault as this runs on a different thread then the networking one (hopefully fixed)
-        for (raknet::ServerConnection &connection: std::views::values(raknetServer.connections)) {
-            if (!connection.playerSpawned) {
-                continue;
-            }
-            auto chunks = dimension.generator.generateChunks(connection);
+        auto &profiler = tickManager.profiler();
+        {
+            auto scope = profiler.measure(inboundPhase);
+            raknetServer.forEachConnection([this](raknet::ServerConnection &connection) {
+                drainInbound(connection);
+            });
+        }
 
-            if (chunks.first.empty()) {
-                continue;
-            }
-            for (world::generator::Chunk *chunk: chunks.second) {
-                send(connection, chunk->serialize());
-            }
+        raknetServer.forEachConnection([this, &profiler](raknet::ServerConnection &connection) {
+            tickConnection(connection);
+
+            auto scope = profiler.measure(sendingPhase);
+            sendPreparedPayloads(connection);
+        });
 
-            protocol::NetworkChunkPublisherUpdatePacket update;
-            update.coordinate = {
-                static_cast<int32_t>(std::floor(connection.playerLocationX)),
-                static_cast<int32_t>(std::floor(connection.playerLocationY)),
-                static_cast<int32_t>(std::floor(connection.playerLocationZ))
-            };
-            update.radius = connection.playerViewDistance << 4;
-            update.savedChunks = std::move(chunks.first);
-            send(connection, update);
+        if (tick % CHUNK_WORKER_REPORT_INTERVAL == 0 && tick > 0) {
+            JERV_LOG_DEBUG("chunk workers: {} queued encodes, {} queued loads", chunkWorkers.queuedJobs(),
+                           dimension.generator.queuedLoads());
         }
     }
 
+    void Jerver::tickConnection(raknet::ServerConnection &connection) {
+        if (!connection.playerSpawned) {
+            return;
+        }
+        auto chunks = [this, &connection] {
+            auto scope = tickManager.profiler().measure(chunkGenerationPhase);
+            return dimension.generator.generateChunks(connection);
+        }();
+
+        if (chunks.first.empty()) {
+            return;
+        }
+
+        auto scope = tickManager.profiler().measure(sendingPhase);
+        for (auto &chunk: chunks.second) {
+            // viewers share the encoded chunk, only the first one after a change queues serializing and compressing
+            // it on a worker
+            auto [payload, needsEncode] = chunk->acquirePayload();
+            queuePreparedPayload(connection, payload);
+            if (needsEncode) {
+                chunkWorkers.submit([this, chunk = std::move(chunk), payload = std::move(payload)] {
+                    encodePacket(chunk->serialize(), *payload);
+                });
+            }
+        }
+
+        protocol::NetworkChunkPublisherUpdatePacket update;
+        update.coordinate = {
+            static_cast<int32_t>(std::floor(connection.playerLocationX)),
+            static_cast<int32_t>(std::floor(connection.playerLocationY)),
+            static_cast<int32_t>(std::floor(connection.playerLocationZ))
+        };
+        update.radius = connection.playerViewDistance << 4;
+        update.savedChunks = std::move(chunks.first);
+        send(connection, update);
+        flush(connection);
+    }
+
     void Jerver::handleData(raknet::ServerConnection &connection, const std::span<uint8_t> data) {
         binary::Cursor cursor(data);
         if (connection.networkSettingsSent) {
             protocol::CompressionAlgorithm compression = static_cast<protocol::CompressionAlgorithm>(cursor.
                 readUint8());
-            // TODO: handle compression
+            if (compression == protocol::CompressionAlgorithm::Zlib) {
+                thread_local network::Inflater inflater;
+
+                auto &scratch = connection.incomingGamePacketScratch;
+                const auto size = inflater.decompress(cursor.getRemainingBytes(), scratch, MAX_INBOUND_BATCH_SIZE);
+                if (!size) {
+                    JERV_LOG_WARN("dropping corrupt or oversized compressed batch from {}", connection.playerName);
+                    return;
+                }
+                cursor = binary::Cursor(std::span(scratch).subspan(0, *size));
+            } else if (compression != protocol::CompressionAlgorithm::NoCompression) {
+                JERV_LOG_WARN("dropping batch with unsupported compression 0x{:X} from {}",
+                              static_cast<uint8_t>(compression), connection.playerName);
+                return;
+            }
         }
 
         while (!cursor.isEndOfStream()) {
@@ -103,43 +217,121 @@ namespace jerv::core {
             cursor.setPointer(cursor.pointer() + packetSize);
             handlePacket(connection, buffer);
         }
+
+        // everything the handlers answered with goes out as one batch
+        flush(connection);
     }
 
     void Jerver::send(raknet::ServerConnection &connection, const protocol::PacketType &packet) {
-        // TODO: sendbatch
-
-        // TODO: handle with one global send buffer and optimise this buffer mess
-        constexpr size_t MAX_PACKET_BUFFER_SIZE = 524288;
-        constexpr size_t MAX_VARINT_SIZE = 5;
-        constexpr size_t MAX_RAKNET_HEADER_SIZE = 2;
-
-        binary::ResizableCursor packetBufferCursor(
-            MAX_PACKET_BUFFER_SIZE + MAX_VARINT_SIZE,
-            MAX_PACKET_BUFFER_SIZE + MAX_VARINT_SIZE
-        );
-        packetBufferCursor.writeVarInt32(static_cast<int32_t>(packet.getPacketId()));
-        packet.serialize(packetBufferCursor);
-
-        binary::ResizableCursor gamePacketBufferCursor(
-            MAX_PACKET_BUFFER_SIZE + MAX_VARINT_SIZE + MAX_VARINT_SIZE,
-            MAX_PACKET_BUFFER_SIZE + MAX_VARINT_SIZE + MAX_VARINT_SIZE
-        );
-        gamePacketBufferCursor.writeVarInt32(static_cast<int32_t>(packetBufferCursor.getProcessedBytes().size()));
-        gamePacketBufferCursor.writeSliceSpan(packetBufferCursor.getProcessedBytes());
-
-        binary::ResizableCursor sendBufferCursor(
-            MAX_PACKET_BUFFER_SIZE + MAX_VARINT_SIZE + MAX_VARINT_SIZE + MAX_RAKNET_HEADER_SIZE,
-            MAX_PACKET_BUFFER_SIZE + MAX_VARINT_SIZE + MAX_VARINT_SIZE + MAX_RAKNET_HEADER_SIZE
-        );
-        sendBufferCursor.writeUint8(static_cast<uint8_t>(raknet::RaknetPacketId::GameData));
-        if (connection.networkSettingsSent) {
-            sendBufferCursor.writeUint8(static_cast<uint8_t>(protocol::CompressionAlgorithm::NoCompression));
-            // TODO handle compression
+        auto &batch = connection.outgoingGamePacketBatch;
+        network::appendGamePacket(batch, packet);
+
+        if (batch.size() >= GAME_PACKET_BATCH_FLUSH_SIZE) {
+            flush(connection);
+        }
+    }
+
+    void Jerver::flush(raknet::ServerConnection &connection) {
+        auto &batch = connection.outgoingGamePacketBatch;
+        if (batch.size() <= network::GAME_BATCH_HEADER_SIZE) {
+            return;
+        }
+
+        const auto framed = network::frameGameBatch(batch, compressionFor(connection));
+        auto &pending = connection.outgoingPreparedPayloads;
+        if (pending.empty() && raknetServer.queueFrame(connection, framed, raknet::Reliable)) {
+            batch.clear();
+            return;
+        }
+
+        // the handoff ring is full or something is still waiting, keep the order by waiting behind it
+        auto payload = std::make_shared<raknet::PreparedPayload>();
+        payload->bytes.assign(framed.begin(), framed.end());
+        payload->ready.store(true, std::memory_order_relaxed);
+        pending.push_back(std::move(payload));
+        batch.clear();
+    }
+
+    network::CompressionSettings Jerver::compressionFor(const raknet::ServerConnection &connection) const {
+        return {connection.networkSettingsSent, compressionThreshold, compressionLevel};
+    }
+
+    void Jerver::broadcast(const protocol::PacketType &packet,
+                           const std::span<raknet::ServerConnection *const> audience) {
+        std::shared_ptr<raknet::PreparedPayload> payload;
+
+        for (raknet::ServerConnection *connection: audience) {
+            if (!connection->networkSettingsSent) {
+                // the shared batch carries a compression byte, which these connections do not expect yet
+                send(*connection, packet);
+                continue;
+            }
+
+            if (!payload) {
+                payload = std::make_shared<raknet::PreparedPayload>();
+                encodePacket(packet, *payload);
+            }
+            queuePreparedPayload(*connection, payload);
         }
+    }
+
+    void Jerver::rebuildJoinSequence() {
+        std::vector<uint8_t> batch;
+        appendJoinSequence(batch);
+
+        auto payload = std::make_shared<raknet::PreparedPayload>();
+        prepareBatch(batch, *payload);
+
+        JERV_LOG_DEBUG("join sequence prepared, {} bytes framed from {}", payload->bytes.size(), batch.size());
+
+        std::lock_guard lock(joinSequenceMutex);
+        joinSequence = std::move(payload);
+    }
 
-        sendBufferCursor.writeSliceSpan(gamePacketBufferCursor.getProcessedBytes());
+    void Jerver::sendJoinSequence(raknet::ServerConnection &connection) {
+        std::shared_ptr<raknet::PreparedPayload> payload;
+        {
+            std::lock_guard lock(joinSequenceMutex);
+            payload = joinSequence;
+        }
+        queuePreparedPayload(connection, std::move(payload));
+    }
+
+    void Jerver::encodePacket(const protocol::PacketType &packet, raknet::PreparedPayload &payload) const {
+        thread_local std::vector<uint8_t> batch;
+        batch.clear();
+        network::appendGamePacket(batch, packet);
+        prepareBatch(batch, payload);
+    }
 
-        raknetServer.sendFrame(connection, sendBufferCursor.getProcessedBytes(), raknet::Reliable);
+    void Jerver::prepareBatch(std::vector<uint8_t> &batch, raknet::PreparedPayload &payload) const {
+        // prepared payloads are shared, so they are always framed for connections that got NetworkSettings
+        const auto framed = network::frameGameBatch(batch, {true, compressionThreshold, compressionLevel});
+        payload.bytes.assign(framed.begin(), framed.end());
+        payload.ready.store(true, std::memory_order_release);
+    }
+
+    void Jerver::queuePreparedPayload(raknet::ServerConnection &connection,
+                                      std::shared_ptr<raknet::PreparedPayload> payload) {
+        // game packets sent before this payload stay ahead of it
+        flush(connection);
+
+        auto &pending = connection.outgoingPreparedPayloads;
+        if (pending.empty() && payload->ready.load(std::memory_order_acquire) &&
+            raknetServer.queueFrame(connection, payload, raknet::Reliable)) {
+            return;
+        }
+        pending.push_back(std::move(payload));
+    }
+
+    void Jerver::sendPreparedPayloads(raknet::ServerConnection &connection) {
+        auto &pending = connection.outgoingPreparedPayloads;
+        while (!pending.empty() && pending.front()->ready.load(std::memory_order_acquire)) {
+            if (!raknetServer.queueFrame(connection, pending.front(), raknet::Reliable)) {
+                return;
+            }
+            pending.pop_front();
+        }
     }
 
     void Jerver::handlePacket(raknet::ServerConnection &connection, const std::span<uint8_t> data) {
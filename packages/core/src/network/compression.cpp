@@ -0,0 +1,129 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jerv/core/network/compression.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "jerv/common/logger.hpp"
+
+namespace jerv::core::network {
+    // negative window bits select raw deflate, without the zlib header and checksum
+    constexpr int RAW_DEFLATE_WINDOW_BITS = -15;
+    constexpr int DEFLATE_MEMORY_LEVEL = 8;
+    constexpr size_t INFLATE_INITIAL_OUTPUT_SIZE = 4096;
+
+    Deflater::Deflater(const int level) : currentLevel(level) {
+        if (deflateInit2(&stream, level, Z_DEFLATED, RAW_DEFLATE_WINDOW_BITS, DEFLATE_MEMORY_LEVEL,
+                         Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("failed to initialize deflate stream");
+        }
+    }
+
+    Deflater::~Deflater() {
+        deflateEnd(&stream);
+    }
+
+    size_t Deflater::compress(const std::span<const uint8_t> input, std::vector<uint8_t> &output, const size_t offset,
+                            const int level) {
+        deflateReset(&stream);
+        if (level != currentLevel) {
+            // the stream was just reset, so there is nothing pending to flush here
+            if (deflateParams(&stream, level, Z_DEFAULT_STRATEGY) == Z_OK) {
+                currentLevel = level;
+            } else {
+                JERV_LOG_WARN("failed to set deflate level {}, keeping level {}", level, currentLevel);
+            }
+        }
+
+        const size_t bound = deflateBound(&stream, static_cast<uLong>(input.size()));
+        if (output.size() < offset + bound) {
+            output.resize(offset + bound);
+        }
+
+        stream.next_in = const_cast<Bytef *>(input.data());
+        stream.avail_in = static_cast<uInt>(input.size());
+        stream.next_out = output.data() + offset;
+        stream.avail_out = static_cast<uInt>(bound);
+
+        if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+            JERV_LOG_ERROR("failed to deflate batch of {} bytes", input.size());
+            return 0;
+        }
+
+        return stream.total_out;
+    }
+
+    Inflater::Inflater() {
+        if (inflateInit2(&stream, RAW_DEFLATE_WINDOW_BITS) != Z_OK) {
+            throw std::runtime_error("failed to initialize inflate stream");
+        }
+    }
+
+    Inflater::~Inflater() {
+        inflateEnd(&stream);
+    }
+
+    std::optional<size_t> Inflater::decompress(const std::span<const uint8_t> input, std::vector<uint8_t> &output,
+                                               const size_t maxSize) {
+        inflateReset(&stream);
+
+        // the buffer may be larger from an earlier batch, only ever use up to maxSize of it
+        size_t capacity = std::min(output.size(), maxSize);
+        if (capacity == 0) {
+            capacity = std::min(INFLATE_INITIAL_OUTPUT_SIZE, maxSize);
+            output.resize(capacity);
+        }
+
+        stream.next_in = const_cast<Bytef *>(input.data());
+        stream.avail_in = static_cast<uInt>(input.size());
+
+        size_t written = 0;
+        while (true) {
+            stream.next_out = output.data() + written;
+            stream.avail_out = static_cast<uInt>(capacity - written);
+
+            const int result = inflate(&stream, Z_NO_FLUSH);
+            written = capacity - stream.avail_out;
+
+            if (result == Z_STREAM_END) {
+                return written;
+            }
+            if (result != Z_OK && result != Z_BUF_ERROR) {
+                return std::nullopt;
+            }
+            if (stream.avail_out != 0) {
+                // inflate stopped with room left, so the input ended before the stream did
+                return std::nullopt;
+            }
+            if (capacity >= maxSize) {
+                return std::nullopt;
+            }
+            capacity = std::min(capacity * 2, maxSize);
+            if (output.size() < capacity) {
+                output.resize(capacity);
+            }
+        }
+    }
+}
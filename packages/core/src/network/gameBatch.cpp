@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jerv/core/network/gameBatch.hpp"
+
+#include "jerv/binary/cursor.hpp"
+#include "jerv/core/network/compression.hpp"
+#include "jerv/protocol/packets/networkSettings.hpp"
+#include "jerv/raknet/protocol/packetIds.hpp"
+
+namespace jerv::core::network {
+    void appendGamePacket(std::vector<uint8_t> &batch, const protocol::PacketType &packet) {
+        // one buffer per thread, the packet is written once behind room for its length, which is filled in
+        // backwards once known
+        thread_local std::vector<uint8_t> packetBuffer(MAX_VARINT_SIZE + MAX_PACKET_BUFFER_SIZE);
+        const std::span<uint8_t> buffer(packetBuffer);
+
+        binary::Cursor packetCursor(buffer.subspan(MAX_VARINT_SIZE));
+        packetCursor.writeVarInt32(static_cast<int32_t>(packet.getPacketId()));
+        packet.serialize(packetCursor);
+        const auto packetSize = static_cast<int32_t>(packetCursor.pointer());
+
+        const size_t start = MAX_VARINT_SIZE - binary::Cursor::varInt32Size(packetSize);
+        binary::Cursor lengthCursor(buffer.subspan(start, MAX_VARINT_SIZE - start));
+        lengthCursor.writeVarInt32(packetSize);
+
+        if (batch.empty()) {
+            // room for the GameData id and the compression byte, written when the batch is framed
+            batch.resize(GAME_BATCH_HEADER_SIZE);
+        }
+        const auto packetBytes = buffer.subspan(start, MAX_VARINT_SIZE - start + packetSize);
+        batch.insert(batch.end(), packetBytes.begin(), packetBytes.end());
+    }
+
+    std::span<uint8_t> frameGameBatch(std::vector<uint8_t> &batch, const CompressionSettings &compression) {
+        if (!compression.enabled) {
+            batch[1] = static_cast<uint8_t>(raknet::RaknetPacketId::GameData);
+            return std::span(batch).subspan(1);
+        }
+
+        const auto payload = std::span(batch).subspan(GAME_BATCH_HEADER_SIZE);
+        if (payload.size() >= compression.threshold) {
+            thread_local Deflater deflater(compression.level);
+            thread_local std::vector<uint8_t> compressed;
+
+            const size_t compressedSize = deflater.compress(payload, compressed, GAME_BATCH_HEADER_SIZE,
+                                                            compression.level);
+            if (compressedSize > 0) {
+                compressed[0] = static_cast<uint8_t>(raknet::RaknetPacketId::GameData);
+                compressed[1] = static_cast<uint8_t>(protocol::CompressionAlgorithm::Zlib);
+                return std::span(compressed).subspan(0, GAME_BATCH_HEADER_SIZE + compressedSize);
+            }
+        }
+
+        batch[0] = static_cast<uint8_t>(raknet::RaknetPacketId::GameData);
+        batch[1] = static_cast<uint8_t>(protocol::CompressionAlgorithm::NoCompression);
+        return batch;
+    }
+}
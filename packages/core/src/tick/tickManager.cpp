@@ -23,8 +23,6 @@
 
 #include "jerv/core/tick/tickManager.hpp"
 
-#include "jerv/common/logger.hpp"
-
 namespace jerv::core::tick {
     TickManager::TickManager() {
     }
@@ -45,12 +43,15 @@ namespace jerv::core::tick {
         while (running) {
             next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
 
-            currentTickStartTime = std::chrono::steady_clock::now();
+            tickProfiler.beginTick(currentTick);
 
             callback(context, currentTick);
+
+            lastTickDuration = tickProfiler.endTick(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval));
             currentTick++;
 
-            auto now = std::chrono::steady_clock::now();
+            const auto now = std::chrono::steady_clock::now();
 
             if (now < next) {
                 std::this_thread::sleep_until(next);
@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jerv/core/tick/tickProfiler.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <spdlog/fmt/fmt.h>
+
+#include "jerv/common/logger.hpp"
+
+namespace jerv::core::tick {
+    namespace {
+        double toMilliseconds(const TickProfiler::Clock::duration duration) {
+            return std::chrono::duration<double, std::milli>(duration).count();
+        }
+    }
+
+    TickProfiler::PhaseId TickProfiler::registerPhase(std::string name) {
+        phases.push_back({std::move(name)});
+        return phases.size() - 1;
+    }
+
+    void TickProfiler::addPhaseTime(const PhaseId phase, const Clock::duration duration) {
+        phases[phase].current += duration;
+    }
+
+    void TickProfiler::beginTick(const uint64_t tick) {
+        currentTick = tick;
+        currentTickStart = Clock::now();
+    }
+
+    TickProfiler::Clock::duration TickProfiler::endTick(const Clock::duration budget) {
+        const Clock::duration duration = Clock::now() - currentTickStart;
+
+        const size_t slot = recorded % WINDOW_TICKS;
+        tickSamples[slot] = duration;
+        tickStarts[slot] = currentTickStart;
+        recorded++;
+
+        if (duration > budget) {
+            warnOverrun(duration, budget);
+        }
+
+        for (Phase &phase: phases) {
+            phase.samples[slot] = phase.current;
+            phase.current = {};
+        }
+
+        if (recorded % REPORT_INTERVAL == 0) {
+            report();
+        }
+        return duration;
+    }
+
+    void TickProfiler::warnOverrun(const Clock::duration duration, const Clock::duration budget) const {
+        std::string breakdown;
+        for (const Phase &phase: phases) {
+            fmt::format_to(std::back_inserter(breakdown), ", {} {:.2f}ms", phase.name, toMilliseconds(phase.current));
+        }
+        JERV_LOG_WARN("tick {} took {:.2f}ms, over the {:.2f}ms budget{}", currentTick, toMilliseconds(duration),
+                      toMilliseconds(budget), breakdown);
+    }
+
+    PhaseStatistics TickProfiler::summarize(const std::string &name, const std::vector<Clock::duration> &samples) {
+        const size_t count = std::min<uint64_t>(recorded, WINDOW_TICKS);
+        sortScratch.assign(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(count));
+
+        const auto percentile = [this, count](const size_t permille) {
+            const size_t rank = std::max<size_t>((count * permille + 999) / 1000, 1) - 1;
+            std::nth_element(sortScratch.begin(), sortScratch.begin() + static_cast<std::ptrdiff_t>(rank),
+                             sortScratch.end());
+            return toMilliseconds(sortScratch[rank]);
+        };
+
+        PhaseStatistics statistics;
+        statistics.name = name;
+        statistics.p50 = percentile(500);
+        statistics.p99 = percentile(990);
+        statistics.max = toMilliseconds(*std::max_element(sortScratch.begin(), sortScratch.end()));
+        return statistics;
+    }
+
+    void TickProfiler::report() {
+        const size_t count = std::min<uint64_t>(recorded, WINDOW_TICKS);
+
+        TickStatistics statistics;
+        Clock::duration total{};
+        for (size_t i = 0; i < count; i++) {
+            total += tickSamples[i];
+        }
+        statistics.mspt = toMilliseconds(total) / static_cast<double>(count);
+
+        // the oldest start still in the window sits right after the newest one once the ring wrapped
+        const Clock::time_point newest = tickStarts[(recorded - 1) % WINDOW_TICKS];
+        const Clock::time_point oldest = tickStarts[recorded > WINDOW_TICKS ? recorded % WINDOW_TICKS : 0];
+        const std::chrono::duration<double> span = newest - oldest;
+        if (span.count() > 0) {
+            statistics.tps = static_cast<double>(count - 1) / span.count();
+        }
+
+        statistics.tick = summarize("tick", tickSamples);
+        std::string line = fmt::format("{:.2f} MSPT, {:.2f} TPS, tick p50 {:.2f}ms p99 {:.2f}ms max {:.2f}ms",
+                                       statistics.mspt, statistics.tps, statistics.tick.p50, statistics.tick.p99,
+                                       statistics.tick.max);
+        for (const Phase &phase: phases) {
+            PhaseStatistics &summary = statistics.phases.emplace_back(summarize(phase.name, phase.samples));
+            fmt::format_to(std::back_inserter(line), " | {} {:.2f}/{:.2f}/{:.2f}ms", summary.name, summary.p50,
+                           summary.p99, summary.max);
+        }
+        JERV_LOG_DEBUG("tick profile over the last {} ticks: {}", count, line);
+
+        std::lock_guard lock(lastReportMutex);
+        lastReport = std::move(statistics);
+    }
+
+    TickStatistics TickProfiler::statistics() const {
+        std::lock_guard lock(lastReportMutex);
+        return lastReport;
+    }
+}
@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "jerv/core/workerPool.hpp"
+
+#include "jerv/common/logger.hpp"
+
+namespace jerv::core {
+    WorkerPool::~WorkerPool() {
+        stop();
+    }
+
+    void WorkerPool::start(const size_t threadCount) {
+        {
+            std::lock_guard lock(jobsMutex);
+            stopping = false;
+        }
+        for (size_t i = 0; i < std::max<size_t>(threadCount, 1); ++i) {
+            threads.emplace_back([this] { run(); });
+        }
+    }
+
+    void WorkerPool::stop() {
+        {
+            std::lock_guard lock(jobsMutex);
+            stopping = true;
+        }
+        jobsAvailable.notify_all();
+
+        for (auto &thread: threads) {
+            if (thread.joinable()) thread.join();
+        }
+        threads.clear();
+    }
+
+    void WorkerPool::submit(Job job) {
+        {
+            std::lock_guard lock(jobsMutex);
+            jobs.push_back(std::move(job));
+        }
+        jobsAvailable.notify_one();
+    }
+
+    size_t WorkerPool::queuedJobs() const {
+        std::lock_guard lock(jobsMutex);
+        return jobs.size();
+    }
+
+    void WorkerPool::run() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock lock(jobsMutex);
+                jobsAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty()) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+
+            try {
+                job();
+            } catch (const std::exception &exception) {
+                JERV_LOG_ERROR("worker job failed: {}", exception.what());
+            }
+        }
+    }
+}
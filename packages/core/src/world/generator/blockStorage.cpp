@@ -23,12 +23,23 @@
 
 #include "jerv/core/world/generator/blockStorage.hpp"
 
+#include <stdexcept>
+#include <spdlog/fmt/fmt.h>
+
 namespace jerv::core::world::generator {
     BlockStorage::BlockStorage() {
         palette.push_back(0);
         blocks.resize(MAX_SIZE, 0);
     }
 
+    BlockStorage::BlockStorage(std::vector<int32_t> palette, std::vector<uint16_t> blocks)
+        : palette(std::move(palette)), blocks(std::move(blocks)) {
+        if (this->palette.empty() || this->blocks.size() != MAX_SIZE) {
+            throw std::invalid_argument(fmt::format("block storage needs a palette and {} blocks, got {} and {}",
+                                                    MAX_SIZE, this->palette.size(), this->blocks.size()));
+        }
+    }
+
     bool BlockStorage::isEmpty() {
         return palette.size() == 1 && palette[0] == 0;
     }
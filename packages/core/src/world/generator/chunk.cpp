@@ -34,14 +34,40 @@ namespace jerv::core::world::generator {
     }
 
     void Chunk::setBlock(const int32_t x, const int32_t y, const int32_t z, const int32_t state, const size_t layer) {
+        std::unique_lock lock(blocksMutex);
         const int32_t index = yToSubChunkIndex(y);
         getSubChunk(index).setState(x & 0xF, y & 0xF, z & 0xF, state, layer);
-        // setDirty();
+        setDirty();
     }
 
-    protocol::LevelChunkPacket Chunk::serialize() {
-        if (cache) return *cache;
+    void Chunk::setSubChunkLayer(const int32_t subChunkY, const size_t layer, BlockStorage storage) {
+        std::unique_lock lock(blocksMutex);
+        const int32_t index = yToSubChunkIndex(subChunkY << 4);
+        getSubChunk(index).setLayer(layer, std::move(storage));
+        setDirty();
+    }
+
+    std::pair<std::shared_ptr<raknet::PreparedPayload>, bool> Chunk::acquirePayload() {
+        if (payload) {
+            return {payload, false};
+        }
+        payload = std::make_shared<raknet::PreparedPayload>();
+        return {payload, true};
+    }
+
+    void Chunk::setDirty() {
+        payload.reset();
+    }
 
+    void Chunk::clear() {
+        std::unique_lock lock(blocksMutex);
+        for (auto &subChunk: subchunks) {
+            subChunk.reset();
+        }
+    }
+
+    protocol::LevelChunkPacket Chunk::serialize() {
+        std::shared_lock lock(blocksMutex);
         binary::ResizableCursor cursor(4096, 65536);
         const int32_t subChunkCount = getSubChunkSendCount();
 
@@ -63,17 +89,18 @@ namespace jerv::core::world::generator {
 
         cursor.writeUint8(0);
 
-        auto data = cursor.getProcessedBytes();
-
         protocol::LevelChunkPacket levelChunkPacket;
         levelChunkPacket.x = chunkX;
         levelChunkPacket.z = chunkZ;
         levelChunkPacket.dimension = dimension;
         levelChunkPacket.subChunkCount = subChunkCount;
-        levelChunkPacket.data = std::vector(data.begin(), data.end());
 
-        cache = levelChunkPacket;
-        return *cache;
+        // the packet takes over the buffer of the cursor instead of copying it
+        auto &data = cursor.ownedBuffer();
+        data.resize(cursor.pointer());
+        levelChunkPacket.data = std::move(data);
+
+        return levelChunkPacket;
     }
 
     int32_t Chunk::getSubChunkSendCount() {
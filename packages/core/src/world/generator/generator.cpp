@@ -24,6 +24,7 @@
 #include "jerv/core/world/generator/generator.hpp"
 
 #include "fastNoise.hpp"
+#include "jerv/common/logger.hpp"
 #include "jerv/raknet/serverConnection.hpp"
 
 namespace jerv::core::world::generator {
@@ -36,7 +37,11 @@ namespace jerv::core::world::generator {
         }
     };
 
-    std::pair<std::vector<protocol::ChunkCoords>, std::vector<Chunk *> > ChunkGenerator::generateChunks(
+    void ChunkGenerator::startLoading(const size_t threadCount) {
+        loaders.start(threadCount);
+    }
+
+    std::pair<std::vector<protocol::ChunkCoords>, std::vector<std::shared_ptr<Chunk> > > ChunkGenerator::generateChunks(
         raknet::ServerConnection &connection) {
         // TODO: All of this definetly still has lots of optimisation potential
         // TODO: Unload all the chunks for players who disconnect
@@ -59,13 +64,16 @@ namespace jerv::core::world::generator {
         std::sort(offsets.begin(), offsets.end());
 
         constexpr uint32_t maxChunksToSend = 8;
-        std::vector<Chunk *> generatedChunks;
+        // loads kept in flight ahead of the sending, so walking away does not leave a long queue of unneeded reads
+        constexpr uint32_t maxPendingLoads = 32;
+        std::vector<std::shared_ptr<Chunk> > generatedChunks;
         std::vector<protocol::ChunkCoords> coords;
 
         generatedChunks.reserve(maxChunksToSend);
         coords.reserve(maxChunksToSend);
 
         uint32_t chunksSend = 0;
+        uint32_t chunksLoading = 0;
 
         std::unordered_set<uint64_t> desiredChunks;
         desiredChunks.reserve(offsets.size());
@@ -77,26 +85,19 @@ namespace jerv::core::world::generator {
             desiredChunks.insert(getChunkKey(chunkX, chunkZ));
         }
 
-        for (auto it = connection.playerLoadedChunks.begin();
-             it != connection.playerLoadedChunks.end();) {
-            if (!desiredChunks.contains(*it)) {
-                auto chunkIt = chunks.find(*it);
-                if (chunkIt != chunks.end()) {
-                    Chunk &chunk = chunkIt->second;
-
-                    if (--chunk.viewers == 0) {
-                        chunks.erase(getChunkKey(chunk.chunkX, chunk.chunkZ));
-                    }
+        for (auto *playerChunks: {&connection.playerLoadedChunks, &connection.playerRequestedChunks}) {
+            for (auto it = playerChunks->begin(); it != playerChunks->end();) {
+                if (!desiredChunks.contains(*it)) {
+                    releaseChunk(*it);
+                    it = playerChunks->erase(it);
+                } else {
+                    ++it;
                 }
-
-                it = connection.playerLoadedChunks.erase(it);
-            } else {
-                ++it;
             }
         }
 
         for (const auto &offset: offsets) {
-            if (chunksSend >= maxChunksToSend) {
+            if (chunksSend >= maxChunksToSend || chunksLoading >= maxPendingLoads) {
                 break;
             }
 
@@ -105,26 +106,45 @@ namespace jerv::core::world::generator {
 
             uint64_t chunkKey = getChunkKey(chunkX, chunkZ);
 
-            auto [it, inserted] = connection.playerLoadedChunks.insert(chunkKey);
-            if (!inserted) {
+            if (connection.playerLoadedChunks.contains(chunkKey)) {
+                continue;
+            }
+
+            std::shared_ptr<Chunk> chunk = generateChunk(chunkX, chunkZ, chunkKey);
+            // counted from the request on, so a chunk that is never sent is still unloaded once out of range
+            if (connection.playerRequestedChunks.insert(chunkKey).second) {
+                ++chunk->viewers;
+            }
+            if (!chunk->isLoaded()) {
+                ++chunksLoading;
                 continue;
             }
 
-            Chunk *chunk = generateChunk(chunkX, chunkZ, chunkKey);
-            ++chunk->viewers;
+            connection.playerRequestedChunks.erase(chunkKey);
+            connection.playerLoadedChunks.insert(chunkKey);
             ++chunksSend;
 
             coords.emplace_back(chunkX, chunkZ);
-            generatedChunks.emplace_back(chunk);
+            generatedChunks.emplace_back(std::move(chunk));
         }
 
         return {std::move(coords), std::move(generatedChunks)};
     }
 
-    Chunk *ChunkGenerator::generateChunk(int32_t chunkX, int32_t chunkZ, const uint64_t chunkKey) {
-        const auto [it, inserted] = chunks.try_emplace(chunkKey, chunkX, chunkZ);
+    std::shared_ptr<Chunk> ChunkGenerator::generateChunk(int32_t chunkX, int32_t chunkZ, const uint64_t chunkKey) {
+        const auto [it, inserted] = chunks.try_emplace(chunkKey);
         if (inserted) {
-            levelDB.readChunk(it->second);
+            it->second = std::make_shared<Chunk>(chunkX, chunkZ);
+            loaders.submit([this, chunk = it->second] {
+                try {
+                    levelDB.readChunk(*chunk);
+                } catch (const std::exception &exception) {
+                    // sent empty rather than left loading forever
+                    JERV_LOG_ERROR("failed to read chunk {} {}: {}", chunk->chunkX, chunk->chunkZ, exception.what());
+                    chunk->clear();
+                }
+                chunk->markLoaded();
+            });
             // FastNoiseLite noise;
             // noise.SetNoiseType(FastNoiseLite::NoiseType_Perlin);
             //
@@ -138,7 +158,14 @@ namespace jerv::core::world::generator {
             // }
         }
 
-        return &it->second;
+        return it->second;
+    }
+
+    void ChunkGenerator::releaseChunk(const uint64_t chunkKey) {
+        const auto it = chunks.find(chunkKey);
+        if (it != chunks.end() && --it->second->viewers == 0) {
+            chunks.erase(it);
+        }
     }
 
     uint64_t ChunkGenerator::getChunkKey(const int32_t chunkX, const int32_t chunkZ) {
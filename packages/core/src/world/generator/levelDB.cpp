@@ -22,7 +22,12 @@
  */
 
 #include "jerv/core/world/generator/levelDB.hpp"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <spdlog/fmt/fmt.h>
 
 #include "jerv/binary/nbt.hpp"
 
@@ -31,173 +36,273 @@
 namespace jerv::core::world::generator {
     class Chunk;
 
-    LevelDB::LevelDB() {
-        leveldb::Options options;
-        options.block_size = 64 * 1024;
-        options.create_if_missing = false;
+    LevelDBSettings::LevelDBSettings(const LevelDBOptions &options) {
+        dbOptions.block_size = options.blockSize;
+        dbOptions.create_if_missing = false;
 
-        leveldb::Status status = leveldb::DB::Open(options,
-                                                   "C:/Users/jeanh/AppData/Roaming/Minecraft Bedrock/Users/17010935870061832014/games/com.mojang/minecraftWorlds/ma6/db",
-                                                   &db);
+        if (options.blockCacheCapacity > 0) {
+            blockCache.reset(leveldb::NewLRUCache(options.blockCacheCapacity));
+            dbOptions.block_cache = blockCache.get();
+        }
+        if (options.bloomFilterBitsPerKey > 0) {
+            filterPolicy.reset(leveldb::NewBloomFilterPolicy(options.bloomFilterBitsPerKey));
+            dbOptions.filter_policy = filterPolicy.get();
+        }
+
+        readOptions.fill_cache = options.fillCache;
+        readOptions.verify_checksums = options.verifyChecksums;
+    }
+
+    LevelDB::~LevelDB() {
+        delete db;
+    }
+
+    bool LevelDB::open(const LevelDBOptions &options) {
+        settings = LevelDBSettings(options);
+
+        leveldb::Status status = leveldb::DB::Open(settings.dbOptions, options.path, &db);
 
         if (!status.ok()) {
-            JERV_LOG_ERROR(status.ToString());
+            JERV_LOG_ERROR("failed to open world {}: {}", options.path, status.ToString());
+            db = nullptr;
+            return false;
         }
+
+        JERV_LOG_INFO("opened world {} ({} KiB block cache, bloom filter {} bits per key)", options.path,
+                      options.blockCacheCapacity / 1024, options.bloomFilterBitsPerKey);
+        return true;
+    }
+
+    leveldb::Iterator &LevelDB::iteratorForThread() {
+        // each loader thread keeps its iterator, a new one per chunk would cost an allocation and a version ref.
+        // It reads the database as of its creation, which is fine while the server never writes to the world
+        thread_local const leveldb::DB *owner = nullptr;
+        thread_local std::unique_ptr<leveldb::Iterator> iterator;
+        if (!iterator || owner != db) {
+            iterator.reset(db->NewIterator(settings.readOptions));
+            owner = db;
+        }
+        return *iterator;
     }
 
     Chunk &LevelDB::readChunk(Chunk &chunk) {
-        std::string chunkIndex;
-        chunkIndex.resize(8);
-        binary::Cursor chunkIndexCursor(
-            std::span(
-                reinterpret_cast<uint8_t *>(chunkIndex.data()),
-                chunkIndex.size()
-            )
-        );
+        if (!db) {
+            return chunk;
+        }
+
+        std::array<uint8_t, CHUNK_KEY_PREFIX_SIZE> chunkIndex{};
+        binary::Cursor chunkIndexCursor(chunkIndex);
 
         chunkIndexCursor.writeInt32<true>(chunk.chunkX);
         chunkIndexCursor.writeInt32<true>(chunk.chunkZ);
 
-        std::string chunkVersion;
-        leveldb::ReadOptions readOptions;
-        leveldb::Status s = db->Get(readOptions, chunkIndex + '\x2c', &chunkVersion);
-        if (!s.ok()) {
-            return chunk;
-        }
+        const leveldb::Slice prefix(reinterpret_cast<const char *>(chunkIndex.data()), chunkIndex.size());
+
+        // every record of a chunk starts with its position and they sort next to each other, so one seek walks only
+        // the records that exist instead of probing all 24 subchunk keys. Other dimensions put a 4 byte dimension id
+        // behind the position, their keys are longer and get skipped
+        leveldb::Iterator &iterator = iteratorForThread();
+        thread_local std::string subChunkData;
+        bool hasVersion = false;
 
-        for (int subChunkY = -4; subChunkY <= 19; ++subChunkY) {
-            std::string subChunkData;
-            leveldb::Status s2 = db->Get(readOptions, chunkIndex + '\x2f' + static_cast<char>(subChunkY & 0xff),
-                                         &subChunkData);
-            if (!s2.ok()) {
+        for (iterator.Seek(prefix); iterator.Valid() && iterator.key().starts_with(prefix); iterator.Next()) {
+            const leveldb::Slice key = iterator.key();
+            const uint8_t tag = key.size() > prefix.size() ? static_cast<uint8_t>(key[prefix.size()]) : 0;
+
+            // the version sorts before the subchunks, chunks without one are not generated yet
+            if (key.size() == prefix.size() + 1 && tag == VERSION_TAG) {
+                hasVersion = true;
                 continue;
             }
-            binary::Cursor subChunkCursor(
-                std::span(
-                    reinterpret_cast<uint8_t *>(subChunkData.data()),
-                    subChunkData.size()
-                )
-            );
-            uint8_t subChunkVersion = subChunkCursor.readUint8();
-            uint8_t storageCount = subChunkCursor.readUint8();
-
-            if (subChunkVersion >= 9) {
-                subChunkCursor.readUint8();
+            if (!hasVersion || key.size() != prefix.size() + 2 || tag != SUB_CHUNK_PREFIX_TAG) {
+                continue;
             }
 
-            for (int storageIndex = 0; storageIndex < storageCount; ++storageIndex) {
-                uint8_t bitsPerBlock = subChunkCursor.readUint8() >> 1;
-
-                size_t packedBytes = 0;
-                int32_t blocksPerWord = 0;
-                int32_t paletteSize = 1;
+            const int32_t subChunkY = static_cast<int8_t>(key[prefix.size() + 1]);
+            if (subChunkY < MIN_SUB_CHUNK_Y || subChunkY > MAX_SUB_CHUNK_Y) {
+                continue;
+            }
 
-                if (bitsPerBlock != 0) {
-                    blocksPerWord = 32 / bitsPerBlock;
-                    const int32_t wordCount = (4096 + blocksPerWord - 1) / blocksPerWord;
-                    packedBytes = static_cast<size_t>(wordCount) * 4;
-                }
+            const leveldb::Slice value = iterator.value();
+            subChunkData.assign(value.data(), value.size());
+            readSubChunk(chunk, subChunkY, std::span(reinterpret_cast<uint8_t *>(subChunkData.data()),
+                                                     subChunkData.size()));
+        }
 
-                auto packedSpan = subChunkCursor.readSliceSpan(packedBytes);
+        return chunk;
+    }
 
-                if (bitsPerBlock != 0) {
-                    paletteSize = subChunkCursor.readInt32<true>();
-                }
+    int32_t LevelDB::blockStateHash(const std::span<uint8_t> entry) {
+        const std::string_view key(reinterpret_cast<const char *>(entry.data()), entry.size());
+        {
+            std::shared_lock lock(blockStateHashesMutex);
+            if (const auto it = blockStateHashes.find(key); it != blockStateHashes.end()) {
+                return it->second;
+            }
+        }
 
-                std::vector<int32_t> paletteStates;
-                paletteStates.resize(paletteSize);
+        const int32_t hash = computeBlockStateHash(entry);
+        std::lock_guard lock(blockStateHashesMutex);
+        blockStateHashes.emplace(key, hash);
+        return hash;
+    }
 
-                for (int blockIndex = 0; blockIndex < paletteSize; ++blockIndex) {
-                    binary::NBT nbt(subChunkCursor);
-                    auto rootValue = nbt.next();
+    int32_t LevelDB::computeBlockStateHash(const std::span<uint8_t> entry) {
+        binary::Cursor entryCursor(entry);
+        binary::NBT nbt(entryCursor);
+        auto rootValue = nbt.next();
 
-                    uint32_t hash = 0x811c9dc5u;
+        uint32_t hash = 0x811c9dc5u;
 
-                    // TODO: don't live calculate all the hashes
-                    auto &rootMap = std::get<std::unordered_map<std::string, binary::NBTData> >(rootValue.value);
+        auto &rootMap = std::get<std::unordered_map<std::string, binary::NBTData> >(rootValue.value);
 
-                    std::vector<uint8_t> nbtBytes;
-                    auto writeString = [&](const std::string &str) {
-                        nbtBytes.push_back(str.length() & 0xFF);
-                        nbtBytes.push_back((str.length() >> 8) & 0xFF);
-                        for (char c: str) nbtBytes.push_back(c);
-                    };
+        std::vector<uint8_t> nbtBytes;
+        auto writeString = [&](const std::string &str) {
+            nbtBytes.push_back(str.length() & 0xFF);
+            nbtBytes.push_back((str.length() >> 8) & 0xFF);
+            for (char c: str) nbtBytes.push_back(c);
+        };
 
-                    nbtBytes.push_back(0x0a);
-                    writeString("");
+        nbtBytes.push_back(0x0a);
+        writeString("");
 
-                    if (rootMap.contains("name")) {
-                        nbtBytes.push_back(0x08);
-                        writeString("name");
-                        writeString(std::get<std::string>(rootMap.at("name").value));
-                    }
+        if (rootMap.contains("name")) {
+            nbtBytes.push_back(0x08);
+            writeString("name");
+            writeString(std::get<std::string>(rootMap.at("name").value));
+        }
 
-                    nbtBytes.push_back(0x0a);
-                    writeString("states");
-
-                    if (rootMap.contains("states")) {
-                        auto &statesMap = std::get<std::unordered_map<std::string, binary::NBTData> >(
-                            rootMap.at("states").value);
-                        std::map<std::string, const binary::NBTData *> orderedStates;
-                        for (const auto &kv: statesMap) {
-                            orderedStates[kv.first] = &kv.second;
-                        }
-
-                        for (const auto &kv: orderedStates) {
-                            const auto &k = kv.first;
-                            const auto *v = kv.second;
-                            nbtBytes.push_back(v->type);
-                            writeString(k);
-                            if (v->type == binary::NBTDataType::Int8) {
-                                nbtBytes.push_back(std::get<int8_t>(v->value));
-                            } else if (v->type == binary::NBTDataType::Int32) {
-                                int32_t val = std::get<int32_t>(v->value);
-                                nbtBytes.push_back(val & 0xFF);
-                                nbtBytes.push_back((val >> 8) & 0xFF);
-                                nbtBytes.push_back((val >> 16) & 0xFF);
-                                nbtBytes.push_back((val >> 24) & 0xFF);
-                            } else if (v->type == binary::NBTDataType::String) {
-                                writeString(std::get<std::string>(v->value));
-                            }
-                        }
-                    }
-                    nbtBytes.push_back(0x00);
-                    nbtBytes.push_back(0x00);
+        nbtBytes.push_back(0x0a);
+        writeString("states");
 
-                    for (uint8_t byte: nbtBytes) {
-                        hash ^= byte;
-                        hash = hash + (hash << 1) + (hash << 4) + (hash << 7) + (hash << 8) + (hash << 24);
-                    }
+        if (rootMap.contains("states")) {
+            auto &statesMap = std::get<std::unordered_map<std::string, binary::NBTData> >(
+                rootMap.at("states").value);
+            std::map<std::string, const binary::NBTData *> orderedStates;
+            for (const auto &kv: statesMap) {
+                orderedStates[kv.first] = &kv.second;
+            }
 
-                    paletteStates[blockIndex] = static_cast<int32_t>(hash);
+            for (const auto &kv: orderedStates) {
+                const auto &k = kv.first;
+                const auto *v = kv.second;
+                nbtBytes.push_back(v->type);
+                writeString(k);
+                if (v->type == binary::NBTDataType::Int8) {
+                    nbtBytes.push_back(std::get<int8_t>(v->value));
+                } else if (v->type == binary::NBTDataType::Int32) {
+                    int32_t val = std::get<int32_t>(v->value);
+                    nbtBytes.push_back(val & 0xFF);
+                    nbtBytes.push_back((val >> 8) & 0xFF);
+                    nbtBytes.push_back((val >> 16) & 0xFF);
+                    nbtBytes.push_back((val >> 24) & 0xFF);
+                } else if (v->type == binary::NBTDataType::String) {
+                    writeString(std::get<std::string>(v->value));
                 }
+            }
+        }
+        nbtBytes.push_back(0x00);
+        nbtBytes.push_back(0x00);
+
+        for (uint8_t byte: nbtBytes) {
+            hash ^= byte;
+            hash = hash + (hash << 1) + (hash << 4) + (hash << 7) + (hash << 8) + (hash << 24);
+        }
 
-                for (int32_t blockIndex = 0; blockIndex < 4096; ++blockIndex) {
-                    uint32_t paletteIndex = 0;
+        return static_cast<int32_t>(hash);
+    }
 
-                    if (bitsPerBlock != 0) {
-                        const int32_t wordIndex = blockIndex / blocksPerWord;
-                        const int32_t bitOffset = (blockIndex % blocksPerWord) * bitsPerBlock;
+    bool LevelDB::isValidBitsPerBlock(const uint8_t bitsPerBlock) {
+        // the widths Bedrock writes, 0 is a single block state without packed indices
+        switch (bitsPerBlock) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+            case 4:
+            case 5:
+            case 6:
+            case 8:
+            case 16:
+                return true;
+            default:
+                return false;
+        }
+    }
 
-                        const uint32_t word = static_cast<uint32_t>(packedSpan[wordIndex * 4]) |
-                                              (static_cast<uint32_t>(packedSpan[wordIndex * 4 + 1]) << 8) |
-                                              (static_cast<uint32_t>(packedSpan[wordIndex * 4 + 2]) << 16) |
-                                              (static_cast<uint32_t>(packedSpan[wordIndex * 4 + 3]) << 24);
+    void LevelDB::readSubChunk(Chunk &chunk, const int32_t subChunkY, const std::span<uint8_t> data) {
+        binary::Cursor subChunkCursor(data);
+        uint8_t subChunkVersion = subChunkCursor.readUint8();
+        uint8_t storageCount = subChunkCursor.readUint8();
 
-                        paletteIndex = (word >> bitOffset) & ((1u << bitsPerBlock) - 1);
-                    }
+        if (subChunkVersion >= 9) {
+            subChunkCursor.readUint8();
+        }
 
-                    const int32_t state = paletteStates[paletteIndex];
+        for (int storageIndex = 0; storageIndex < storageCount; ++storageIndex) {
+            uint8_t bitsPerBlock = subChunkCursor.readUint8() >> 1;
+            if (!isValidBitsPerBlock(bitsPerBlock)) {
+                throw std::runtime_error(fmt::format("invalid subchunk storage of {} bits per block",
+                                                     static_cast<int>(bitsPerBlock)));
+            }
 
-                    const int32_t x = (blockIndex >> 8) & 0xF;
-                    const int32_t z = (blockIndex >> 4) & 0xF;
-                    const int32_t y = blockIndex & 0xF;
+            size_t packedBytes = 0;
+            int32_t blocksPerWord = 0;
+            int32_t paletteSize = 1;
 
-                    chunk.setBlock(x, (subChunkY << 4) + y, z, state, storageIndex);
+            if (bitsPerBlock != 0) {
+                blocksPerWord = 32 / bitsPerBlock;
+                const int32_t wordCount = (4096 + blocksPerWord - 1) / blocksPerWord;
+                packedBytes = static_cast<size_t>(wordCount) * 4;
+            }
+
+            auto packedSpan = subChunkCursor.readSliceSpan(packedBytes);
+
+            if (bitsPerBlock != 0) {
+                paletteSize = subChunkCursor.readInt32<true>();
+                if (paletteSize <= 0 || paletteSize > BlockStorage::MAX_SIZE) {
+                    throw std::runtime_error(fmt::format("invalid subchunk palette size {}", paletteSize));
                 }
             }
-        }
 
-        return chunk;
+            std::vector<int32_t> paletteStates;
+            paletteStates.resize(paletteSize);
+
+            for (int blockIndex = 0; blockIndex < paletteSize; ++blockIndex) {
+                const size_t entryStart = subChunkCursor.pointer();
+                binary::NBT entry(subChunkCursor);
+                entry.skip();
+                paletteStates[blockIndex] = blockStateHash(
+                    data.subspan(entryStart, subChunkCursor.pointer() - entryStart));
+            }
+
+            // disk and BlockStorage both keep blocks in x, z, y order, so the indices are unpacked straight into place
+            std::vector<uint16_t> blocks(BlockStorage::MAX_SIZE, 0);
+            if (bitsPerBlock != 0) {
+                const uint32_t mask = (1u << bitsPerBlock) - 1;
+                size_t blockIndex = 0;
+
+                for (size_t wordOffset = 0; wordOffset < packedBytes; wordOffset += 4) {
+                    uint32_t word = static_cast<uint32_t>(packedSpan[wordOffset]) |
+                                    (static_cast<uint32_t>(packedSpan[wordOffset + 1]) << 8) |
+                                    (static_cast<uint32_t>(packedSpan[wordOffset + 2]) << 16) |
+                                    (static_cast<uint32_t>(packedSpan[wordOffset + 3]) << 24);
+
+                    for (int32_t slot = 0; slot < blocksPerWord && blockIndex < blocks.size(); ++slot) {
+                        blocks[blockIndex++] = static_cast<uint16_t>(word & mask);
+                        word >>= bitsPerBlock;
+                    }
+                }
+
+                // only corrupt data points past the palette, those blocks fall back to the first entry
+                for (uint16_t &index: blocks) {
+                    if (index >= paletteSize) {
+                        index = 0;
+                    }
+                }
+            }
+
+            chunk.setSubChunkLayer(subChunkY, storageIndex, BlockStorage(std::move(paletteStates), std::move(blocks)));
+        }
     }
 }
@@ -31,6 +31,10 @@ namespace jerv::core::world::generator {
         return layers[index];
     }
 
+    void SubChunk::setLayer(const size_t index, BlockStorage storage) {
+        getLayer(index) = std::move(storage);
+    }
+
     int32_t SubChunk::getState(const int32_t x, const int32_t y, const int32_t z, const size_t layer) {
         if (layer >= layers.size()) return 0;
         return layers[layer].getState(x, y, z);
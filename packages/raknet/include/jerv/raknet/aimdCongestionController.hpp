@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <limits>
+
+#include "congestionController.hpp"
+#include "constants.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief Slow start followed by additive increase, halving the window at most once per loss event.
+     * Losses of datagrams sent before the last reduction belong to the same event and are ignored.
+     */
+    class AimdCongestionController final : public CongestionController {
+    public:
+        explicit AimdCongestionController(const size_t mtu)
+            : mtu(mtu),
+              window(INITIAL_CONGESTION_WINDOW_DATAGRAMS * mtu),
+              minWindow(MIN_CONGESTION_WINDOW_DATAGRAMS * mtu),
+              maxWindow(MAX_CONGESTION_WINDOW_DATAGRAMS * mtu) {
+        }
+
+        void onAcknowledged(const size_t bytes, const TimePoint sentTime, TimePoint) override {
+            if (sentTime <= recoveryStart) {
+                return;
+            }
+
+            if (window < slowStartThreshold) {
+                window += bytes;
+            } else {
+                window += std::max<size_t>(mtu * bytes / window, 1);
+            }
+            window = std::min(window, maxWindow);
+        }
+
+        void onLost(size_t, const TimePoint sentTime, const TimePoint now) override {
+            if (sentTime <= recoveryStart) {
+                return;
+            }
+
+            recoveryStart = now;
+            window = std::max(window / 2, minWindow);
+            slowStartThreshold = window;
+        }
+
+        void onRetransmissionTimeout(const TimePoint now) override {
+            recoveryStart = now;
+            slowStartThreshold = std::max(window / 2, minWindow);
+            window = minWindow;
+        }
+
+        size_t congestionWindow() const override {
+            return window;
+        }
+
+    private:
+        size_t mtu;
+        size_t window;
+        size_t minWindow;
+        size_t maxWindow;
+        size_t slowStartThreshold = std::numeric_limits<size_t>::max();
+        TimePoint recoveryStart{};
+    };
+}
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 namespace jerv::raknet {
@@ -52,6 +53,22 @@ namespace jerv::raknet {
             return true;
         }
 
+        // doubles the capacity instead of rejecting the item when the queue is full
+        void enqueueGrowing(T item) {
+            if (size_ == buffer_.size()) {
+                std::vector<T> grown(std::max<size_t>(buffer_.size() * 2, 1));
+                for (size_t i = 0; i < size_; ++i) {
+                    grown[i] = std::move(buffer_[(tailCursor_ + i) % buffer_.size()]);
+                }
+                buffer_ = std::move(grown);
+                tailCursor_ = 0;
+                headCursor_ = size_;
+            }
+            buffer_[headCursor_] = std::move(item);
+            headCursor_ = (headCursor_ + 1) % buffer_.size();
+            size_++;
+        }
+
         T dequeue() {
             if (size_ == 0) return T{};
             T item = std::move(buffer_[tailCursor_]);
@@ -64,6 +81,13 @@ namespace jerv::raknet {
             return buffer_[tailCursor_];
         }
 
+        template<typename Fn>
+        void forEach(Fn &&fn) {
+            for (size_t i = 0; i < size_; ++i) {
+                fn(buffer_[(tailCursor_ + i) % buffer_.size()]);
+            }
+        }
+
         bool isEmpty() const {
             return size_ == 0;
         }
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace jerv::raknet {
+    /**
+     * @brief Decides how many bytes of reliable datagrams a connection may have in flight.
+     * The server reports every acknowledged and lost datagram, implementations only have to keep the window.
+     */
+    class CongestionController {
+    public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        virtual ~CongestionController() = default;
+
+        virtual void onAcknowledged(size_t bytes, TimePoint sentTime, TimePoint now) = 0;
+
+        // a NACK reported the datagram missing
+        virtual void onLost(size_t bytes, TimePoint sentTime, TimePoint now) = 0;
+
+        // the oldest datagram in flight was not acknowledged within the retransmission timeout
+        virtual void onRetransmissionTimeout(TimePoint now) = 0;
+
+        virtual size_t congestionWindow() const = 0;
+    };
+}
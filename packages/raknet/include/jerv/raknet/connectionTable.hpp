@@ -0,0 +1,189 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <asio/ip/udp.hpp>
+
+#include "serverConnection.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief Address and port of a peer packed into plain integers, v4 addresses are stored v4-mapped (::ffff:a.b.c.d)
+     */
+    struct EndpointKey {
+        uint64_t high = 0;
+        uint64_t low = 0;
+        uint16_t port = 0;
+
+        static EndpointKey fromEndpoint(const asio::ip::udp::endpoint &endpoint) {
+            EndpointKey key;
+            key.port = endpoint.port();
+
+            const asio::ip::address address = endpoint.address();
+            if (address.is_v4()) {
+                key.low = 0xFFFF'0000'0000ULL | address.to_v4().to_uint();
+                return key;
+            }
+
+            const auto bytes = address.to_v6().to_bytes();
+            for (size_t i = 0; i < 8; i++) {
+                key.high = key.high << 8 | bytes[i];
+                key.low = key.low << 8 | bytes[i + 8];
+            }
+            return key;
+        }
+
+        uint64_t hash() const {
+            uint64_t value = high * 0x9E37'79B9'7F4A'7C15ULL ^ low ^ static_cast<uint64_t>(port) << 48;
+            value ^= value >> 33;
+            value *= 0xFF51'AFD7'ED55'8CCDULL;
+            value ^= value >> 33;
+            value *= 0xC4CE'B9FE'1A85'EC53ULL;
+            value ^= value >> 33;
+            return value;
+        }
+
+        bool operator==(const EndpointKey &) const = default;
+    };
+
+    /**
+     * @brief Open addressing (linear probing) table from endpoint to connection.
+     * Connections are heap allocated once on connect, so the returned references stay valid while the table grows.
+     * They are shared, erasing only drops the reference of the table.
+     */
+    class ConnectionTable {
+    public:
+        ConnectionTable() : slots(INITIAL_CAPACITY) {
+        }
+
+        ServerConnection *find(const EndpointKey &key) const {
+            for (size_t index = indexFor(key); slots[index].connection; index = next(index)) {
+                if (slots[index].key == key) {
+                    return slots[index].connection.get();
+                }
+            }
+            return nullptr;
+        }
+
+        /**
+         * @brief Creates the connection if there is none for this key yet
+         * @return the connection stored for this key
+         */
+        template<typename... Args>
+        ServerConnection &tryEmplace(const EndpointKey &key, Args &&... args) {
+            if (ServerConnection *existing = find(key)) {
+                return *existing;
+            }
+
+            if ((count + 1) * 2 > slots.size()) {
+                grow();
+            }
+
+            size_t index = indexFor(key);
+            while (slots[index].connection) {
+                index = next(index);
+            }
+
+            slots[index].key = key;
+            slots[index].connection = std::make_shared<ServerConnection>(std::forward<Args>(args)...);
+            count++;
+            return *slots[index].connection;
+        }
+
+        bool erase(const EndpointKey &key) {
+            size_t index = indexFor(key);
+            while (slots[index].connection && !(slots[index].key == key)) {
+                index = next(index);
+            }
+            if (!slots[index].connection) {
+                return false;
+            }
+
+            slots[index].connection.reset();
+            count--;
+
+            // backward shift the rest of the cluster, so lookups never need tombstones
+            size_t hole = index;
+            for (size_t current = next(index); slots[current].connection; current = next(current)) {
+                const size_t home = indexFor(slots[current].key);
+                const bool reachable = hole <= current ? home > hole && home <= current : home > hole || home <= current;
+                if (reachable) {
+                    continue;
+                }
+                slots[hole] = std::move(slots[current]);
+                hole = current;
+            }
+            return true;
+        }
+
+        template<typename Fn>
+        void forEach(Fn &&fn) {
+            for (Slot &slot: slots) {
+                if (slot.connection) {
+                    fn(*slot.connection);
+                }
+            }
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+    private:
+        static constexpr size_t INITIAL_CAPACITY = 64;
+
+        struct Slot {
+            EndpointKey key;
+            std::shared_ptr<ServerConnection> connection;
+        };
+
+        size_t indexFor(const EndpointKey &key) const {
+            return key.hash() & (slots.size() - 1);
+        }
+
+        size_t next(const size_t index) const {
+            return (index + 1) & (slots.size() - 1);
+        }
+
+        void grow() {
+            std::vector<Slot> old = std::exchange(slots, std::vector<Slot>(slots.size() * 2));
+            for (Slot &slot: old) {
+                if (!slot.connection) {
+                    continue;
+                }
+                size_t index = indexFor(slot.key);
+                while (slots[index].connection) {
+                    index = next(index);
+                }
+                slots[index] = std::move(slot);
+            }
+        }
+
+        std::vector<Slot> slots;
+        size_t count = 0;
+    };
+}
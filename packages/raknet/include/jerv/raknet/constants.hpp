@@ -22,6 +22,7 @@
  */
 
 #pragma once
+#include <chrono>
 #include <cstdint>
 
 namespace jerv::raknet {
@@ -31,6 +32,7 @@ namespace jerv::raknet {
     constexpr const char *NETWORK_LOOPBACK_ADDRESS4 = "127.0.0.1";
     constexpr const char *NETWORK_ANY_ADDRESS6 = "::0";
     constexpr const char *NETWORK_LOOPBACK_ADDRESS6 = "::1";
+    constexpr size_t NETWORK_DEFAULT_SHARD_COUNT = 1;
 
     constexpr uint8_t ONLINE_DATAGRAM_BIT_MASK = 0b1110'0000;
     constexpr uint8_t VALID_DATAGRAM_BIT = 0b1000'0000;
@@ -45,6 +47,46 @@ namespace jerv::raknet {
     constexpr size_t MAX_CAPSULE_HEADER_SIZE = CAPSULE_FRAGMENT_META_SIZE + 13;
     constexpr size_t MAX_FRAME_SET_HEADER_SIZE = MAX_CAPSULE_HEADER_SIZE + 4;
 
+    constexpr size_t RECEIVE_BATCH_SIZE = 64;
+    constexpr size_t RECEIVE_SLOT_SIZE = 2048;
+    constexpr size_t RECEIVE_MAX_BATCHES_PER_WAKEUP = 8;
+
+    constexpr size_t SEND_BATCH_SIZE = 64;
+    constexpr size_t SEND_SLOT_SIZE = 2048;
+    constexpr size_t SEND_MAX_SEGMENTS = 64;
+    constexpr size_t SEND_MAX_SEGMENTED_SIZE = 65507;
+    constexpr bool SEND_SEGMENT_OFFLOAD = true;
+    // retries of a sendmmsg that failed with EAGAIN or ENOBUFS before its datagrams are dropped
+    constexpr size_t SEND_TRANSIENT_RETRIES = 3;
+
+    constexpr size_t UNACKNOWLEDGED_DATAGRAM_WINDOW = 1024;
+    constexpr size_t MAX_INCOMING_FRAGMENT_COUNT = 1024;
+    // per connection, fragmented packets beyond either limit are dropped
+    constexpr size_t MAX_INCOMING_FRAGMENTED_PACKETS = 32;
+    constexpr size_t MAX_INCOMING_FRAGMENT_BYTES = 4 * 1024 * 1024;
+    constexpr std::chrono::milliseconds INCOMING_FRAGMENT_TIMEOUT{10000};
+
+    constexpr std::chrono::milliseconds RESEND_TIMER_INTERVAL{20};
+    constexpr std::chrono::milliseconds INITIAL_RETRANSMISSION_TIMEOUT{1000};
+    constexpr std::chrono::milliseconds MIN_RETRANSMISSION_TIMEOUT{100};
+    constexpr std::chrono::milliseconds MAX_RETRANSMISSION_TIMEOUT{3000};
+    constexpr std::chrono::milliseconds CONNECTED_PING_INTERVAL{2000};
+
+    constexpr size_t INITIAL_CONGESTION_WINDOW_DATAGRAMS = 16;
+    constexpr size_t MIN_CONGESTION_WINDOW_DATAGRAMS = 2;
+    // the congestion window counts bytes, this only sizes it in full datagrams of the mtu
+    constexpr size_t MAX_CONGESTION_WINDOW_DATAGRAMS = UNACKNOWLEDGED_DATAGRAM_WINDOW / 2;
+    // small datagrams fit the byte window many times over, so their count is capped on its own below the ring size
+    constexpr size_t MAX_DATAGRAMS_IN_FLIGHT = UNACKNOWLEDGED_DATAGRAM_WINDOW / 2;
+    constexpr double PACING_GAIN = 1.25;
+    constexpr size_t PACING_BURST_DATAGRAMS = 8;
+    // frames the tick thread can hand to a connection before the network thread picks them up
+    constexpr size_t OUTGOING_HANDOFF_CAPACITY = 256;
+    // handoff slots that grew past this for a large frame give the memory back once it is sent
+    constexpr size_t OUTGOING_HANDOFF_RETAINED_CAPACITY = IDEAL_MAX_MTU_SIZE;
+    // game batches the network thread can hand to the tick thread per connection before the client is dropped
+    constexpr size_t INCOMING_HANDOFF_CAPACITY = 128;
+
     constexpr bool IS_RELIABLE_LOOKUP[] = {false, false, true, true, true};
     constexpr bool IS_SEQUENCED_LOOKUP[] = {false, true, false, false, true};
     constexpr bool IS_ORDERED_LOOKUP[] = {false, true, false, true, true};
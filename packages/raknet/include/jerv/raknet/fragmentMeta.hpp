@@ -22,40 +22,115 @@
  */
 
 #pragma once
+#include <bitset>
+#include <chrono>
 #include <cstdint>
-#include <map>
-#include <ranges>
+#include <cstring>
 #include <span>
 #include <vector>
 
+#include "constants.hpp"
+#include "frameCapsule.hpp"
+
 namespace jerv::raknet {
+    /**
+     * @brief Rebuilds a fragmented packet in one buffer that is allocated once the layout of the packet is known.
+     * Every fragment but the last has the same size, so the first of them fixes the size of the whole packet and each
+     * fragment, the last one included, is written straight to its final offset. Only a last fragment that arrives
+     * before any other is kept aside until then.
+     */
     class FragmentMeta {
     public:
-        void set(uint32_t index, std::span<uint8_t> data) {
-            if (fragments.contains(index)) {
-                return;
+        /**
+         * @param budget bytes the rebuilt packet may still grow by
+         * @return false if the fragment doesn't match the layout of the others or outgrows the budget, the packet has
+         * to be dropped then
+         */
+        bool set(const FragmentInfo &fragment, const std::span<uint8_t> data, const size_t maxFragmentSize,
+                 const size_t budget, const std::chrono::steady_clock::time_point now) {
+            if (count == 0) {
+                if (fragment.length == 0 || fragment.length > MAX_INCOMING_FRAGMENT_COUNT) {
+                    return false;
+                }
+                count = fragment.length;
+            }
+
+            if (fragment.length != count || fragment.index >= count || data.size() > maxFragmentSize) {
+                return false;
+            }
+
+            if (received[fragment.index]) {
+                return true;
+            }
+
+            const bool isLast = fragment.index == count - 1;
+            if (stride == 0) {
+                if (isLast && count > 1) {
+                    // the offset of the last fragment depends on the size of the others, which isn't known yet
+                    if (data.size() > budget) {
+                        return false;
+                    }
+                    pending.assign(data.begin(), data.end());
+                    lastSize = data.size();
+                    return accept(fragment.index, now);
+                }
+                if (data.empty() || pending.size() > data.size() || count * data.size() > budget + pending.size()) {
+                    return false;
+                }
+                stride = data.size();
+                buffer.resize(count * stride);
+                if (received[count - 1]) {
+                    std::memcpy(buffer.data() + (count - 1) * stride, pending.data(), pending.size());
+                    pending = {};
+                }
+            } else if (isLast ? data.size() > stride : data.size() != stride) {
+                return false;
             }
-            fragments[index] = std::vector(data.begin(), data.end());
-            totalSize += data.size();
+
+            std::memcpy(buffer.data() + fragment.index * stride, data.data(), data.size());
+            if (isLast) {
+                lastSize = data.size();
+            }
+            return accept(fragment.index, now);
         }
 
-        size_t length() const {
-            return fragments.size();
+        bool isComplete() const {
+            return count != 0 && receivedCount == count;
         }
 
-        std::vector<uint8_t> build() const {
-            std::vector<uint8_t> result;
-            result.reserve(totalSize);
+        // bytes held for the packet so far
+        size_t size() const {
+            return buffer.size() + pending.size();
+        }
 
-            for (const auto &fragment: fragments | std::views::values) {
-                result.insert(result.end(), fragment.begin(), fragment.end());
-            }
+        std::chrono::steady_clock::time_point lastUpdate() const {
+            return updated;
+        }
 
-            return result;
+        /**
+         * @brief Hands out the rebuilt packet, the meta is empty afterwards
+         */
+        std::vector<uint8_t> build() {
+            // the last fragment may be shorter than the room left for it
+            buffer.resize((count - 1) * stride + lastSize);
+            return std::move(buffer);
         }
 
     private:
-        std::map<uint32_t, std::vector<uint8_t> > fragments;
-        size_t totalSize = 0;
+        bool accept(const size_t index, const std::chrono::steady_clock::time_point now) {
+            received[index] = true;
+            receivedCount++;
+            updated = now;
+            return true;
+        }
+
+        std::vector<uint8_t> buffer;
+        std::vector<uint8_t> pending;
+        std::bitset<MAX_INCOMING_FRAGMENT_COUNT> received;
+        std::chrono::steady_clock::time_point updated;
+        size_t count = 0;
+        size_t receivedCount = 0;
+        size_t stride = 0;
+        size_t lastSize = 0;
     };
-}
\ No newline at end of file
+}
@@ -23,7 +23,11 @@
 
 #pragma once
 #include <cstdint>
+#include <memory>
 #include <span>
+#include <vector>
+
+#include "preparedPayload.hpp"
 
 namespace jerv::raknet {
     struct FragmentInfo {
@@ -46,5 +50,16 @@ namespace jerv::raknet {
     struct CapsuleCache {
         FrameCapsule frame;
         uint8_t reliability;
+        // keeps a shared body alive instead of copying it, it is immutable once ready
+        std::shared_ptr<PreparedPayload> payload;
+        // owns the body once the capsule has to wait for the congestion window, moving keeps frame.body valid
+        std::vector<uint8_t> storage;
+
+        void detach() {
+            if (!payload && storage.empty() && !frame.body.empty()) {
+                storage.assign(frame.body.begin(), frame.body.end());
+                frame.body = storage;
+            }
+        }
     };
 }
\ No newline at end of file
@@ -34,7 +34,7 @@ namespace jerv::raknet {
         }
 
         void serialize(jerv::binary::Cursor &cursor) const override {
-            (void) cursor;
+            cursor.writeUint64(timeSinceStart);
         }
 
         void deserialize(binary::Cursor &cursor) override {
@@ -40,7 +40,8 @@ namespace jerv::raknet {
         }
 
         void deserialize(binary::Cursor &cursor) override {
-            (void) cursor;
+            timeSinceStartClient = cursor.readUint64();
+            timeSinceStartServer = cursor.readUint64();
         }
     };
 }
@@ -23,10 +23,15 @@
 
 #pragma once
 #include <asio.hpp>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <vector>
 
+#include "aimdCongestionController.hpp"
 #include "constants.hpp"
 #include "frameCapsule.hpp"
+#include "raknetShard.hpp"
 #include "reliability.hpp"
 #include "serverConnection.hpp"
 #include "jerv/binary/cursor.hpp"
@@ -37,39 +42,103 @@ namespace jerv::raknet {
 
     class RaknetServer {
     public:
+        /**
+         * @brief Sets how many sockets and network threads share the port, has to be called before binding
+         */
+        void setShardCount(size_t count);
+
         void bindV4(uint16_t port = NETWORK_LAN_DISCOVERY_PORT4, const std::string &address = NETWORK_ANY_ADDRESS4);
 
+        /**
+         * @brief Binds the v6 sockets, on a host without IPv6 it logs a warning and keeps serving IPv4 only
+         */
         void bindV6(uint16_t port = NETWORK_LAN_DISCOVERY_PORT6, const std::string &address = NETWORK_ANY_ADDRESS6);
 
         void start();
 
         template<size_t BufferSize = IDEAL_MAX_MTU_SIZE>
-        void sendPacketOffline(const asio::ip::udp::endpoint &endpoint, const RaknetBasePacket &packet);
+        void sendPacketOffline(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint,
+                               const RaknetBasePacket &packet);
 
         void sendPacketOnline(ServerConnection &connection, const RaknetBasePacket &packet, Reliability reliability);
 
-        void sendData(const asio::ip::udp::endpoint &endpoint, std::span<uint8_t> buffer);
+        void sendData(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint, std::span<uint8_t> buffer);
 
+        // network thread of the connection only, everything else goes through queueFrame
         void sendFrame(ServerConnection &connection, std::span<uint8_t> data,
                        Reliability reliability);
 
+        /**
+         * @brief Copies the frame into the handoff ring of the connection, the network thread sends it on its next pass.
+         * Only one thread may queue frames, returns false while the ring is full so the caller can keep it for later.
+         */
+        bool queueFrame(ServerConnection &connection, std::span<const uint8_t> data, Reliability reliability);
+
+        bool queueFrame(ServerConnection &connection, std::shared_ptr<PreparedPayload> payload,
+                        Reliability reliability);
+
+        /**
+         * @brief Marks the connection closed, it stops receiving right away and leaves the table on the next resend sweep
+         */
         void disconnectClient(ServerConnection& connection);
 
+        // runs on the network thread of the connection, the data only lives for the call
         using Callback = void(*)(void*, ServerConnection&, std::span<uint8_t>);
         void setCallback(void* ctx, const Callback cb) {
             context = ctx;
             callback = cb;
         }
 
-        std::unordered_map<std::string, ServerConnection> connections;
+        using CongestionControllerFactory = std::function<std::unique_ptr<CongestionController>(uint16_t mtu)>;
+        /**
+         * @brief Replaces the congestion controller new connections are created with, AIMD by default
+         */
+        void setCongestionControllerFactory(CongestionControllerFactory factory) {
+            congestionControllerFactory = std::move(factory);
+        }
+
+        /**
+         * @brief Calls fn for every open connection without holding the connection locks, so the network threads keep
+         * receiving while fn runs. The connections are kept alive for the call, one closed meanwhile is still visited.
+         */
+        template<typename Fn>
+        void forEachConnection(Fn &&fn) {
+            std::vector<std::shared_ptr<ServerConnection> > snapshot;
+            for (const auto &shard: shards) {
+                std::lock_guard lock(shard->connectionsMutex);
+                snapshot.reserve(snapshot.size() + shard->connections.size());
+                shard->connections.forEach([&snapshot](ServerConnection &connection) {
+                    if (!connection.closed.load(std::memory_order_acquire)) {
+                        snapshot.push_back(connection.shared_from_this());
+                    }
+                });
+            }
+
+            for (const auto &connection: snapshot) {
+                fn(*connection);
+            }
+        }
+
     private:
-        void startReceive(asio::ip::udp::socket &socket);
+        void createShards();
+
+        RaknetSocket &openSocket(RaknetShard &shard, std::unique_ptr<RaknetSocket> &slot,
+                                 const asio::ip::udp &protocol);
+
+        static binary::Address toAddress(const asio::ip::udp::endpoint &endpoint);
 
-        void onMessage(const asio::ip::udp::endpoint &endpoint, std::span<uint8_t> data);
+        void startReceive(RaknetShard &shard, RaknetSocket &socket);
 
-        void handleOnline(const asio::ip::udp::endpoint &endpoint, binary::Cursor &cursor);
+#ifdef __linux__
+        void receiveBatch(RaknetShard &shard, RaknetSocket &socket);
+#endif
 
-        void handleOffline(const asio::ip::udp::endpoint &endpoint, uint8_t packetId, binary::Cursor &cursor);
+        void onMessage(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint, std::span<uint8_t> data);
+
+        void handleOnline(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint, binary::Cursor &cursor);
+
+        void handleOffline(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint, uint8_t packetId,
+                           binary::Cursor &cursor);
 
         void handleFrameSet(ServerConnection &connection, binary::Cursor &cursor);
 
@@ -84,7 +153,19 @@ namespace jerv::raknet {
 
         void handleNack(ServerConnection &connection, binary::Cursor &cursor);
 
-        std::string endpointToString(const asio::ip::udp::endpoint &endpoint);
+        // false when the slot of the frame set id still holds a datagram in flight, the entry is left as it is
+        bool storeUnacknowledged(ServerConnection &connection, UnacknowledgedRing::Entry &entry);
+
+        void sendUnacknowledged(ServerConnection &connection, UnacknowledgedRing::Entry &entry);
+
+        // false when the resend is held back until the slot of the next frame set id is free
+        bool resendUnacknowledged(ServerConnection &connection, UnacknowledgedRing::Entry &entry);
+
+        void startResendTimer(RaknetShard &shard);
+
+        void updateConnection(ServerConnection &connection);
+
+        bool canSendQueued(ServerConnection &connection) const;
 
 
         void handleFrame(ServerConnection &connection, const std::span<uint8_t> &span);
@@ -92,24 +173,37 @@ namespace jerv::raknet {
         void sendAck(ServerConnection &connection, RaknetPacketId type,
                      const std::vector<std::pair<uint32_t, uint32_t> > &ranges);
 
-        void sendCapsule(ServerConnection &connection, const FrameCapsule &frameCapsule, Reliability reliability);
+        // payload is the shared body frameCapsule points into, if any, so a held back capsule doesn't have to copy it
+        void sendCapsule(ServerConnection &connection, const FrameCapsule &frameCapsule, Reliability reliability,
+                         const std::shared_ptr<PreparedPayload> &payload = nullptr);
+
+        // splits the frame into capsules on the send queue without sending anything yet
+        void enqueueFrame(ServerConnection &connection, std::span<uint8_t> data, Reliability reliability,
+                          const std::shared_ptr<PreparedPayload> &payload = nullptr);
+
+        void scheduleHandoff(ServerConnection &connection);
+
+        void drainHandoff(ServerConnection &connection);
 
         void processQueue(ServerConnection &connection);
 
+        void detachQueued(ServerConnection &connection);
+
         void createCurrentConnectionBuffer(ServerConnection &connection);
 
-        mutable std::mutex connectionsMutex;
+        void flushSendBatch(RaknetShard &shard);
+
         int64_t serverGuid = 0;
         uint64_t serverStartTime = 0;
 
-        asio::io_context ioContext;
-        std::unique_ptr<asio::ip::udp::socket> socket4;
-        std::unique_ptr<asio::ip::udp::socket> socket6;
-
-        std::array<uint8_t, 65536> receiveBuffer = {};
-        asio::ip::udp::endpoint remoteEndpoint;
+        size_t shardCount = NETWORK_DEFAULT_SHARD_COUNT;
+        std::vector<std::unique_ptr<RaknetShard> > shards;
 
         void* context = nullptr;
         Callback callback = nullptr;
+
+        CongestionControllerFactory congestionControllerFactory = [](const uint16_t mtu) {
+            return std::make_unique<AimdCongestionController>(mtu);
+        };
     };
 }
@@ -0,0 +1,77 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <asio.hpp>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "connectionTable.hpp"
+#include "receiveBatch.hpp"
+#include "sendBatch.hpp"
+#include "serverConnection.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief A bound socket together with its own receive slots and outgoing batch
+     */
+    struct RaknetSocket {
+        std::unique_ptr<asio::ip::udp::socket> socket;
+
+#ifdef __linux__
+        std::unique_ptr<ReceiveBatch> receiveBatchSlots = std::make_unique<ReceiveBatch>();
+#else
+        std::array<uint8_t, 65536> receiveBuffer = {};
+        asio::ip::udp::endpoint remoteEndpoint;
+#endif
+
+#ifdef __linux__
+        std::mutex sendMutex;
+        std::unique_ptr<SendBatch> sendBatchSlots = std::make_unique<SendBatch>();
+#endif
+    };
+
+    /**
+     * @brief One socket per address family bound with SO_REUSEPORT, running on its own io context thread.
+     * The kernel hashes every client onto a single shard, so a shard owns its slice of the connections exclusively.
+     */
+    struct RaknetShard {
+        asio::io_context ioContext;
+        asio::steady_timer resendTimer{ioContext};
+        std::thread thread;
+
+        std::unique_ptr<RaknetSocket> socket4;
+        std::unique_ptr<RaknetSocket> socket6;
+
+        ConnectionTable connections;
+        mutable std::mutex connectionsMutex;
+
+        // v6 peers, including v4-mapped ones of a dual-stack socket, are always answered on the v6 socket
+        RaknetSocket &socketFor(const asio::ip::udp::endpoint &endpoint) {
+            if (endpoint.protocol() == asio::ip::udp::v6() && socket6) {
+                return *socket6;
+            }
+            return *socket4;
+        }
+    };
+}
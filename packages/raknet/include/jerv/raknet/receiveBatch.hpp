@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#ifdef __linux__
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <sys/socket.h>
+#include <asio/ip/udp.hpp>
+
+#include "constants.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief Preallocated ring of datagram slots filled with a single recvmmsg call.
+     * The sender endpoints are written straight into asio endpoints, so draining a batch does not allocate.
+     */
+    class ReceiveBatch {
+    public:
+        ReceiveBatch() : storage(RECEIVE_BATCH_SIZE * RECEIVE_SLOT_SIZE) {
+            for (size_t i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+                iovecs[i].iov_base = storage.data() + i * RECEIVE_SLOT_SIZE;
+                iovecs[i].iov_len = RECEIVE_SLOT_SIZE;
+            }
+        }
+
+        /**
+         * @brief Receives up to RECEIVE_BATCH_SIZE datagrams without blocking
+         * @return the amount of datagrams received, 0 if the socket had nothing to read
+         */
+        size_t receive(const int fd) {
+            for (size_t i = 0; i < RECEIVE_BATCH_SIZE; i++) {
+                msghdr &header = headers[i].msg_hdr;
+                header = {};
+                header.msg_name = endpoints[i].data();
+                header.msg_namelen = static_cast<socklen_t>(endpoints[i].capacity());
+                header.msg_iov = &iovecs[i];
+                header.msg_iovlen = 1;
+                headers[i].msg_len = 0;
+            }
+
+            const int count = recvmmsg(fd, headers.data(), RECEIVE_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+            if (count <= 0) {
+                return 0;
+            }
+
+            for (int i = 0; i < count; i++) {
+                endpoints[i].resize(headers[i].msg_hdr.msg_namelen);
+            }
+            return static_cast<size_t>(count);
+        }
+
+        std::span<uint8_t> data(const size_t index) {
+            return {static_cast<uint8_t *>(iovecs[index].iov_base), headers[index].msg_len};
+        }
+
+        const asio::ip::udp::endpoint &endpoint(const size_t index) const {
+            return endpoints[index];
+        }
+
+        // datagrams bigger than a slot got cut off by the kernel and can't be parsed
+        bool isTruncated(const size_t index) const {
+            return (headers[index].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+        }
+
+    private:
+        std::vector<uint8_t> storage;
+        std::array<iovec, RECEIVE_BATCH_SIZE> iovecs{};
+        std::array<mmsghdr, RECEIVE_BATCH_SIZE> headers{};
+        std::array<asio::ip::udp::endpoint, RECEIVE_BATCH_SIZE> endpoints;
+    };
+}
+#endif
@@ -0,0 +1,71 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+
+#include "constants.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief Smoothed round trip time and retransmission timeout of a connection, as described in RFC 6298
+     */
+    class RttEstimator {
+    public:
+        using Duration = std::chrono::steady_clock::duration;
+
+        void addSample(const Duration sample) {
+            if (!hasSample) {
+                smoothedRtt = sample;
+                rttVariation = sample / 2;
+                hasSample = true;
+            } else {
+                const Duration delta = smoothedRtt > sample ? smoothedRtt - sample : sample - smoothedRtt;
+                rttVariation = (rttVariation * 3 + delta) / 4;
+                smoothedRtt = (smoothedRtt * 7 + sample) / 8;
+            }
+            timeout = std::clamp<Duration>(smoothedRtt + std::max<Duration>(RESEND_TIMER_INTERVAL, rttVariation * 4),
+                                           MIN_RETRANSMISSION_TIMEOUT, MAX_RETRANSMISSION_TIMEOUT);
+        }
+
+        // doubles the timeout after it expired, until the next sample comes in
+        void backoff() {
+            timeout = std::min<Duration>(timeout * 2, MAX_RETRANSMISSION_TIMEOUT);
+        }
+
+        Duration retransmissionTimeout() const {
+            return timeout;
+        }
+
+        Duration smoothed() const {
+            return smoothedRtt;
+        }
+
+    private:
+        bool hasSample = false;
+        Duration smoothedRtt{};
+        Duration rttVariation{};
+        Duration timeout = INITIAL_RETRANSMISSION_TIMEOUT;
+    };
+}
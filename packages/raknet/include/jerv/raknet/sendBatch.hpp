@@ -0,0 +1,200 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#ifdef __linux__
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <asio/ip/udp.hpp>
+
+#include "constants.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief Preallocated queue of outgoing datagrams emitted with a single sendmmsg call.
+     * Consecutive datagrams to the same endpoint that share a size are merged into one UDP_SEGMENT (GSO) message
+     * when the kernel supports it, so a fragmented packet costs one syscall and one trip through the stack.
+     */
+    class SendBatch {
+    public:
+        SendBatch() : storage(SEND_BATCH_SIZE * SEND_SLOT_SIZE) {
+            for (size_t i = 0; i < SEND_BATCH_SIZE; i++) {
+                iovecs[i].iov_base = storage.data() + i * SEND_SLOT_SIZE;
+            }
+        }
+
+        /**
+         * @brief Copies the datagram into the next free slot
+         * @return false if the batch is full or the datagram doesn't fit in a slot, flush or send it directly then
+         */
+        bool queue(const asio::ip::udp::endpoint &endpoint, const std::span<const uint8_t> data) {
+            if (count == SEND_BATCH_SIZE || data.size() > SEND_SLOT_SIZE) {
+                return false;
+            }
+
+            std::memcpy(iovecs[count].iov_base, data.data(), data.size());
+            iovecs[count].iov_len = data.size();
+            endpoints[count] = endpoint;
+            count++;
+            return true;
+        }
+
+        bool isFull() const {
+            return count == SEND_BATCH_SIZE;
+        }
+
+        bool isEmpty() const {
+            return count == 0;
+        }
+
+        /**
+         * @brief Sends every queued datagram and empties the batch
+         * Datagrams the kernel refuses are dropped, same as a lost packet on the wire.
+         */
+        void flush(const int fd) {
+            size_t next = 0;
+            size_t transientRetries = 0;
+            while (next < count) {
+                const size_t messageCount = buildMessages(next);
+                const int sent = sendmmsg(fd, headers.data(), messageCount, 0);
+
+                if (sent <= 0) {
+                    const int error = sent < 0 ? errno : EAGAIN;
+                    if (error == EINTR) {
+                        continue;
+                    }
+                    // full socket buffer or out of kernel memory for a moment, worth a few more tries
+                    if ((error == EAGAIN || error == EWOULDBLOCK || error == ENOBUFS) &&
+                        transientRetries < SEND_TRANSIENT_RETRIES) {
+                        transientRetries++;
+                        continue;
+                    }
+                    // no checksum offload or an old kernel, retry the same datagrams without segmentation
+                    if (isSegmentOffloadUnsupported(error) && segmentOffload && messageDatagrams[0] > 1) {
+                        segmentOffload = false;
+                        continue;
+                    }
+                    transientRetries = 0;
+                    next += messageDatagrams[0];
+                    continue;
+                }
+
+                transientRetries = 0;
+                for (int i = 0; i < sent; i++) {
+                    next += messageDatagrams[i];
+                }
+            }
+            count = 0;
+        }
+
+    private:
+        static bool isSegmentOffloadUnsupported(const int error) {
+            return error == EINVAL || error == EIO || error == EOPNOTSUPP;
+        }
+
+        union ControlBuffer {
+            cmsghdr header;
+            uint8_t data[CMSG_SPACE(sizeof(uint16_t))];
+        };
+
+        // fills the message headers starting at the given datagram, returns the amount of messages
+        size_t buildMessages(size_t datagram) {
+            size_t messageCount = 0;
+
+            while (datagram < count) {
+                const size_t runLength = segmentOffload ? segmentRunLength(datagram) : 1;
+
+                msghdr &header = headers[messageCount].msg_hdr;
+                header = {};
+                header.msg_name = const_cast<sockaddr *>(endpoints[datagram].data());
+                header.msg_namelen = static_cast<socklen_t>(endpoints[datagram].size());
+                header.msg_iov = &iovecs[datagram];
+                header.msg_iovlen = runLength;
+                headers[messageCount].msg_len = 0;
+
+#ifdef UDP_SEGMENT
+                if (runLength > 1) {
+                    header.msg_control = controls[messageCount].data;
+                    header.msg_controllen = sizeof(controls[messageCount].data);
+
+                    cmsghdr *control = CMSG_FIRSTHDR(&header);
+                    control->cmsg_level = SOL_UDP;
+                    control->cmsg_type = UDP_SEGMENT;
+                    control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    const auto segmentSize = static_cast<uint16_t>(iovecs[datagram].iov_len);
+                    std::memcpy(CMSG_DATA(control), &segmentSize, sizeof(segmentSize));
+                }
+#endif
+
+                messageDatagrams[messageCount++] = runLength;
+                datagram += runLength;
+            }
+
+            return messageCount;
+        }
+
+        // GSO cuts the payload into equally sized segments, only the last one may be shorter
+        size_t segmentRunLength(const size_t first) const {
+#ifdef UDP_SEGMENT
+            const size_t segmentSize = iovecs[first].iov_len;
+            size_t totalSize = segmentSize;
+            size_t length = 1;
+
+            while (first + length < count && length < SEND_MAX_SEGMENTS) {
+                const size_t size = iovecs[first + length].iov_len;
+                if (endpoints[first + length] != endpoints[first] || size > segmentSize ||
+                    totalSize + size > SEND_MAX_SEGMENTED_SIZE) {
+                    break;
+                }
+
+                totalSize += size;
+                length++;
+
+                if (size < segmentSize) {
+                    break;
+                }
+            }
+            return length;
+#else
+            (void) first;
+            return 1;
+#endif
+        }
+
+        std::vector<uint8_t> storage;
+        std::array<iovec, SEND_BATCH_SIZE> iovecs{};
+        std::array<asio::ip::udp::endpoint, SEND_BATCH_SIZE> endpoints;
+        std::array<mmsghdr, SEND_BATCH_SIZE> headers{};
+        std::array<size_t, SEND_BATCH_SIZE> messageDatagrams{};
+        std::array<ControlBuffer, SEND_BATCH_SIZE> controls{};
+        size_t count = 0;
+        bool segmentOffload = SEND_SEGMENT_OFFLOAD;
+    };
+}
+#endif
@@ -0,0 +1,74 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+
+#include "constants.hpp"
+
+namespace jerv::raknet {
+    /**
+     * @brief Token bucket spreading datagrams over a round trip instead of sending the whole window at once.
+     * Refills at PACING_GAIN times the congestion window per smoothed RTT, no pacing before the first RTT sample.
+     */
+    class SendPacer {
+    public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+        using Duration = std::chrono::steady_clock::duration;
+
+        explicit SendPacer(const size_t mtu) : burst(static_cast<double>(PACING_BURST_DATAGRAMS * mtu)),
+                                               tokens(burst) {
+        }
+
+        void refill(const size_t congestionWindow, const Duration smoothedRtt, const TimePoint now) {
+            const auto elapsed = now - lastRefill;
+            lastRefill = now;
+
+            if (smoothedRtt <= Duration::zero()) {
+                tokens = std::max(tokens, static_cast<double>(congestionWindow));
+                return;
+            }
+
+            const double bytesPerSecond = PACING_GAIN * static_cast<double>(congestionWindow) /
+                                          std::chrono::duration<double>(smoothedRtt).count();
+            // the send timer only ticks every RESEND_TIMER_INTERVAL, so allow at least two ticks worth of bytes
+            const double limit = std::max(
+                burst, bytesPerSecond * 2 * std::chrono::duration<double>(RESEND_TIMER_INTERVAL).count());
+            tokens = std::min(tokens + bytesPerSecond * std::chrono::duration<double>(elapsed).count(), limit);
+        }
+
+        bool canSend(const size_t pendingBytes) const {
+            return tokens > static_cast<double>(pendingBytes);
+        }
+
+        void onSent(const size_t bytes) {
+            tokens -= static_cast<double>(bytes);
+        }
+
+    private:
+        double burst;
+        double tokens;
+        TimePoint lastRefill = std::chrono::steady_clock::now();
+    };
+}
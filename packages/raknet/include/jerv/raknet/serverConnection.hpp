@@ -22,28 +22,86 @@
  */
 
 #pragma once
+#include <atomic>
+#include <deque>
 #include <map>
+#include <memory>
 #include <set>
-#include <mutex>
 #include <unordered_set>
 #include <asio/ip/udp.hpp>
 #include <utility>
 
 #include "circularBufferQueue.hpp"
+#include "congestionController.hpp"
 #include "fragmentMeta.hpp"
 #include "frameCapsule.hpp"
+#include "preparedPayload.hpp"
 #include "constants.hpp"
+#include "rttEstimator.hpp"
+#include "sendPacer.hpp"
+#include "spscRing.hpp"
+#include "unacknowledgedRing.hpp"
 
 namespace jerv::raknet {
     class RaknetBasePacket;
+    struct RaknetShard;
 
-    class ServerConnection {
+    struct CongestionStatistics {
+        size_t congestionWindow = 0;
+        size_t bytesInFlight = 0;
+        uint64_t datagramsSent = 0;
+        uint64_t datagramsLost = 0;
+
+        double lossRate() const {
+            return datagramsSent == 0 ? 0.0 : static_cast<double>(datagramsLost) / static_cast<double>(datagramsSent);
+        }
+    };
+
+    /**
+     * @brief Frame waiting in the handoff ring, either copied into bytes or a shared prepared payload
+     */
+    struct OutgoingFrame {
+        std::vector<uint8_t> bytes;
+        std::shared_ptr<PreparedPayload> payload;
+        uint8_t reliability = 0;
+
+        std::span<uint8_t> body() {
+            return payload ? std::span(payload->bytes) : std::span(bytes);
+        }
+    };
+
+    /**
+     * @brief Shared so queued game data can keep it alive past the disconnect, the table holds the owning reference
+     */
+    class ServerConnection : public std::enable_shared_from_this<ServerConnection> {
     public:
-        ServerConnection(asio::ip::udp::endpoint endpoint, asio::ip::udp::socket *socket,
-                         const uint16_t mtu, const int64_t guid) : guid(guid), mtu(mtu),
-                                                                   outgoingMtu(mtu - UDP_HEADER_SIZE),
-                                                                   outgoingBuffer(IDEAL_MAX_MTU_SIZE),
-                                                                   endpoint(std::move(endpoint)), socket(socket) {
+        ServerConnection(asio::ip::udp::endpoint endpoint, RaknetShard *shard,
+                         const uint16_t mtu, const int64_t guid,
+                         std::unique_ptr<CongestionController> congestion) : guid(guid), mtu(mtu),
+                                                                             outgoingMtu(mtu - UDP_HEADER_SIZE),
+                                                                             congestion(std::move(congestion)),
+                                                                             pacer(outgoingMtu),
+                                                                             outgoingBuffer(IDEAL_MAX_MTU_SIZE),
+                                                                             endpoint(std::move(endpoint)),
+                                                                             shard(shard) {
+        }
+
+        // safe from any thread, as of the last send pass of the network thread
+        CongestionStatistics congestionStatistics() const {
+            return {
+                publishedCongestionWindow.load(std::memory_order_relaxed),
+                publishedBytesInFlight.load(std::memory_order_relaxed),
+                publishedDatagramsSent.load(std::memory_order_relaxed),
+                publishedDatagramsLost.load(std::memory_order_relaxed)
+            };
+        }
+
+        // network thread only, the outgoing state itself is never shared so it needs no lock
+        void publishCongestionStatistics() {
+            publishedCongestionWindow.store(congestion->congestionWindow(), std::memory_order_relaxed);
+            publishedBytesInFlight.store(outgoingBytesInFlight, std::memory_order_relaxed);
+            publishedDatagramsSent.store(outgoingDatagramsSent, std::memory_order_relaxed);
+            publishedDatagramsLost.store(outgoingDatagramsLost, std::memory_order_relaxed);
         }
 
         // TODO: Temporary data store here, player stuff later goes into a seperate player class
@@ -57,17 +115,40 @@ namespace jerv::raknet {
 
         int32_t playerViewDistance = 0;
         std::unordered_set<uint64_t> playerLoadedChunks;
+        // asked for but still loading, so not sent yet
+        std::unordered_set<uint64_t> playerRequestedChunks;
+        // tick thread only
+        std::vector<uint8_t> outgoingGamePacketBatch;
+        std::vector<uint8_t> incomingGamePacketScratch;
+        // encoded on workers or held back by a full handoff ring, sent in this order once each is ready
+        std::deque<std::shared_ptr<PreparedPayload> > outgoingPreparedPayloads;
+
+        // filled by the tick thread, drained by the network thread of the shard
+        SpscRing<OutgoingFrame> outgoingHandoff{OUTGOING_HANDOFF_CAPACITY};
+        std::atomic<bool> outgoingHandoffScheduled{false};
+        // filled by the network thread of the shard, drained by the tick thread, the slots double as a buffer pool
+        SpscRing<std::vector<uint8_t> > incomingHandoff{INCOMING_HANDOFF_CAPACITY};
+        std::atomic<size_t> incomingHandoffBytes{0};
 
         int64_t guid;
         uint16_t mtu;
         uint16_t outgoingMtu;
         std::chrono::steady_clock::time_point incomingLastActivity;
-        std::map<uint32_t, std::vector<CapsuleCache> > outgoingUnacknowledgedCache;
-        size_t outgoingUnacknowledgedReliableCapsules = 0;
+        UnacknowledgedRing outgoingUnacknowledgedCache{UNACKNOWLEDGED_DATAGRAM_WINDOW};
+        uint32_t outgoingOldestUnacknowledged = 0;
+        RttEstimator rtt;
+        std::chrono::steady_clock::time_point outgoingLastPing = std::chrono::steady_clock::now();
+        std::unique_ptr<CongestionController> congestion;
+        SendPacer pacer;
+        size_t outgoingBytesInFlight = 0;
+        size_t outgoingDatagramsInFlight = 0;
+        uint64_t outgoingDatagramsSent = 0;
+        uint64_t outgoingDatagramsLost = 0;
         uint32_t incomingLastDatagramId = -1;
         std::set<uint32_t> incomingMissingDatagram;
         std::vector<uint32_t> incomingReceivedDatagramAcknowledgeStack;
         std::map<uint16_t, FragmentMeta> incomingFragmentRebuildTable;
+        size_t incomingFragmentBytes = 0;
 
         std::map<uint8_t, uint32_t> outgoingOrderChannels;
         std::map<uint8_t, uint32_t> outgoingSequenceChannels;
@@ -75,18 +156,26 @@ namespace jerv::raknet {
         uint16_t outgoingNextFragmentId = 0;
         uint32_t outgoingReliableIndex = 0;
         CircularBufferQueue<CapsuleCache> outgoingToSendStack{1024};
-        size_t unacknowledgedWindowSize = 512;
 
         size_t outgoingBufferCursor = 4;
         std::vector<uint8_t> outgoingBuffer;
         uint32_t outgoingFrameSetId = 0;
-        std::vector<CapsuleCache> outgoingUnacknowledgedStack;
+        UnacknowledgedRing::Entry outgoingUnacknowledgedPending;
+        UnacknowledgedRing::Entry outgoingResendScratch;
+        std::vector<uint8_t> outgoingResendBuffer = std::vector<uint8_t>(IDEAL_MAX_MTU_SIZE);
 
         asio::ip::udp::endpoint endpoint;
-        asio::ip::udp::socket *socket = nullptr;
+        RaknetShard *shard = nullptr;
 
         bool networkSettingsSent = false;
 
-        mutable std::recursive_mutex outgoingMutex;
+        // set by disconnectClient, the shard drops closed connections from its table on the next resend sweep
+        std::atomic<bool> closed{false};
+
+    private:
+        std::atomic<size_t> publishedCongestionWindow{0};
+        std::atomic<size_t> publishedBytesInFlight{0};
+        std::atomic<uint64_t> publishedDatagramsSent{0};
+        std::atomic<uint64_t> publishedDatagramsLost{0};
     };
 }
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace jerv::raknet {
+    /**
+     * @brief Bounded lock-free ring between exactly one producer and one consumer thread.
+     * Slots are constructed once and reused, so a slot keeps the capacity of whatever it held before.
+     */
+    template<typename T>
+    class SpscRing {
+    public:
+        explicit SpscRing(const size_t capacity) : slots(std::bit_ceil(capacity)), mask(slots.size() - 1) {
+        }
+
+        // producer: the next free slot to fill, nullptr while the ring is full
+        T *claim() {
+            const size_t head = writeCursor.load(std::memory_order_relaxed);
+            if (head - cachedReadCursor == slots.size()) {
+                cachedReadCursor = readCursor.load(std::memory_order_acquire);
+                if (head - cachedReadCursor == slots.size()) {
+                    return nullptr;
+                }
+            }
+            return &slots[head & mask];
+        }
+
+        // producer: hands the claimed slot to the consumer
+        void publish() {
+            writeCursor.store(writeCursor.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        // consumer: how many published slots can be peeked
+        size_t readable() const {
+            return writeCursor.load(std::memory_order_acquire) - readCursor.load(std::memory_order_relaxed);
+        }
+
+        // consumer: offset has to be below readable()
+        T &peek(const size_t offset) {
+            return slots[(readCursor.load(std::memory_order_relaxed) + offset) & mask];
+        }
+
+        // consumer: gives the first count slots back to the producer
+        void pop(const size_t count) {
+            readCursor.store(readCursor.load(std::memory_order_relaxed) + count, std::memory_order_release);
+        }
+
+    private:
+        std::vector<T> slots;
+        size_t mask;
+
+        alignas(64) std::atomic<size_t> writeCursor{0};
+        size_t cachedReadCursor = 0;
+
+        alignas(64) std::atomic<size_t> readCursor{0};
+    };
+}
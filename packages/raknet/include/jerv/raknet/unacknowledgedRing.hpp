@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: LGPL-3.0-or-later
+ * ============================================================================
+ *  Jerv - Minecraft Bedrock Server Software
+ *  Copyright (C) 2025-2026 jeanmajid
+ *  https://github.com/jeanmajid/Jerv
+ * ============================================================================
+ *
+ * This file is part of Jerv.
+ *
+ * Jerv is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Jerv is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with Jerv. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace jerv::raknet {
+    /**
+     * @brief Reliable capsules of the datagrams in flight, indexed by frameSetId % capacity.
+     * Frame set ids are dense and only go up, so a slot is reused once its datagram is acknowledged. Entries keep the
+     * serialized capsules, which get resent as they are in a new datagram, and are swapped instead of copied so their
+     * buffers keep their capacity, making lookups O(1) and allocation free once warmed up.
+     */
+    class UnacknowledgedRing {
+    public:
+        struct Entry {
+            uint32_t frameSetId = 0;
+            bool inUse = false;
+            bool retransmitted = false;
+            std::chrono::steady_clock::time_point sentTime;
+            size_t capsuleCount = 0;
+            std::vector<uint8_t> capsules;
+        };
+
+        // capacity has to be a power of two, so the 24 bit frame set ids of acks map onto the same slots
+        explicit UnacknowledgedRing(const size_t capacity) : entries(capacity), mask(capacity - 1) {
+        }
+
+        Entry &slot(const uint32_t frameSetId) {
+            return entries[frameSetId & mask];
+        }
+
+        Entry *find(const uint32_t frameSetId) {
+            Entry &entry = entries[frameSetId & mask];
+            if (!entry.inUse || entry.frameSetId != (frameSetId & FRAME_SET_ID_MASK)) {
+                return nullptr;
+            }
+            return &entry;
+        }
+
+        static void reset(Entry &entry) {
+            entry.inUse = false;
+            entry.retransmitted = false;
+            entry.capsuleCount = 0;
+            entry.capsules.clear();
+        }
+
+        // bytes of the datagram on the wire, the capsules plus the datagram header
+        static size_t datagramSize(const Entry &entry) {
+            return entry.capsules.size() + 4;
+        }
+
+        size_t capacity() const {
+            return entries.size();
+        }
+
+        static constexpr uint32_t FRAME_SET_ID_MASK = 0xFFFFFF;
+
+    private:
+        std::vector<Entry> entries;
+        size_t mask;
+    };
+}
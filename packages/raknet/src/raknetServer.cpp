@@ -44,31 +44,122 @@
 #include "jerv/raknet/serverConnection.hpp"
 
 namespace jerv::raknet {
+    void RaknetServer::setShardCount(const size_t count) {
+#ifdef __linux__
+        shardCount = std::max<size_t>(count, 1);
+#else
+        if (count > 1) {
+            JERV_LOG_WARN("SO_REUSEPORT load balancing is only supported on linux, using a single network thread");
+        }
+        shardCount = 1;
+#endif
+    }
+
     void RaknetServer::bindV4(uint16_t port, const std::string &address) {
-        socket4 = std::make_unique<asio::ip::udp::socket>(ioContext);
-        socket4->open(asio::ip::udp::v4());
+        createShards();
+
+        for (const auto &shard: shards) {
+            RaknetSocket &socket = openSocket(*shard, shard->socket4, asio::ip::udp::v4());
 
 #ifdef _WIN32
-        constexpr BOOL opt = TRUE;
-        setsockopt(
-            socket4->native_handle(),
-            IPPROTO_IP,
-            IP_DONTFRAGMENT,
-            reinterpret_cast<const char *>(&opt),
-            sizeof(opt)
-        );
+            constexpr BOOL opt = TRUE;
+            setsockopt(
+                socket.socket->native_handle(),
+                IPPROTO_IP,
+                IP_DONTFRAGMENT,
+                reinterpret_cast<const char *>(&opt),
+                sizeof(opt)
+            );
 #endif
 
-        socket4->bind(asio::ip::udp::endpoint(asio::ip::make_address(address), port));
+            socket.socket->bind(asio::ip::udp::endpoint(asio::ip::make_address(address), port));
 
-        JERV_LOG_INFO("listening on {}:{}", address, port);
+            startReceive(*shard, socket);
+        }
 
-        startReceive(*socket4);
+        JERV_LOG_INFO("listening on {}:{} ({} network threads)", address, port, shardCount);
     }
 
     void RaknetServer::bindV6(uint16_t port, const std::string &address) {
-        (void) port;
-        (void) address;
+        createShards();
+
+        // without a separate v4 listener the v6 socket also accepts v4 clients as v4-mapped addresses
+        const bool dualStack = !shards.front()->socket4;
+
+        // every shard is bound before any starts receiving, so a failure can drop the v6 sockets without a pending wait
+        try {
+            for (const auto &shard: shards) {
+                RaknetSocket &socket = openSocket(*shard, shard->socket6, asio::ip::udp::v6());
+                socket.socket->set_option(asio::ip::v6_only(!dualStack));
+                socket.socket->bind(asio::ip::udp::endpoint(asio::ip::make_address(address), port));
+            }
+        } catch (const std::exception &error) {
+            for (const auto &shard: shards) {
+                shard->socket6.reset();
+            }
+            JERV_LOG_WARN("IPv6 is unavailable ({}), continuing with IPv4 only", error.what());
+            if (dualStack) {
+                bindV4(port);
+            }
+            return;
+        }
+
+        for (const auto &shard: shards) {
+            startReceive(*shard, *shard->socket6);
+        }
+
+        JERV_LOG_INFO("listening on [{}]:{} ({} network threads{})", address, port, shardCount,
+                      dualStack ? ", dual-stack" : "");
+    }
+
+    void RaknetServer::createShards() {
+        if (!shards.empty()) {
+            return;
+        }
+
+        for (size_t i = 0; i < shardCount; i++) {
+            startResendTimer(*shards.emplace_back(std::make_unique<RaknetShard>()));
+        }
+    }
+
+    RaknetSocket &RaknetServer::openSocket(RaknetShard &shard, std::unique_ptr<RaknetSocket> &slot,
+                                           const asio::ip::udp &protocol) {
+        slot = std::make_unique<RaknetSocket>();
+        slot->socket = std::make_unique<asio::ip::udp::socket>(shard.ioContext);
+        slot->socket->open(protocol);
+
+#ifdef __linux__
+        if (shardCount > 1) {
+            constexpr int opt = 1;
+            setsockopt(slot->socket->native_handle(), SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt));
+        }
+#endif
+
+        return *slot;
+    }
+
+    binary::Address RaknetServer::toAddress(const asio::ip::udp::endpoint &endpoint) {
+        const asio::ip::address address = endpoint.address();
+        if (address.is_v4()) {
+            return {.family = 4, .ip = address.to_v4().to_uint(), .port = endpoint.port()};
+        }
+
+        const asio::ip::address_v6 address6 = address.to_v6();
+        if (address6.is_v4_mapped()) {
+            return {
+                .family = 4,
+                .ip = asio::ip::make_address_v4(asio::ip::v4_mapped, address6).to_uint(),
+                .port = endpoint.port()
+            };
+        }
+
+        return {
+            .family = 6,
+            .ip = 0,
+            .port = endpoint.port(),
+            .ip6 = address6.to_bytes(),
+            .scopeId = static_cast<uint32_t>(address6.scope_id())
+        };
     }
 
     void RaknetServer::start() {
@@ -83,18 +174,32 @@ namespace jerv::raknet {
             std::chrono::system_clock::now().time_since_epoch()
         ).count();
 
-        ioContext.run();
+        if (shards.empty()) {
+            return;
+        }
+
+        for (size_t i = 1; i < shards.size(); i++) {
+            RaknetShard &shard = *shards[i];
+            shard.thread = std::thread([&shard] { shard.ioContext.run(); });
+        }
+
+        shards[0]->ioContext.run();
+
+        for (size_t i = 1; i < shards.size(); i++) {
+            if (shards[i]->thread.joinable()) shards[i]->thread.join();
+        }
     }
 
     template<size_t BufferSize>
-    void RaknetServer::sendPacketOffline(const asio::ip::udp::endpoint &endpoint, const RaknetBasePacket &packet) {
+    void RaknetServer::sendPacketOffline(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint,
+                                         const RaknetBasePacket &packet) {
         std::array<uint8_t, BufferSize + 1> data;
         binary::Cursor cursor(data);
         cursor.writeUint8(static_cast<uint8_t>(packet.getPacketId()));
         packet.serialize(cursor);
 
-        socket4->send_to(asio::buffer(data, cursor.processedBytesSize()),
-                         endpoint);
+        shard.socketFor(endpoint).socket->send_to(asio::buffer(data, cursor.processedBytesSize()),
+                                                  endpoint);
     }
 
     void RaknetServer::sendPacketOnline(ServerConnection &connection, const RaknetBasePacket &packet,
@@ -109,47 +214,116 @@ namespace jerv::raknet {
         sendFrame(connection, cursor.getProcessedBytes(), reliability);
     }
 
-    void RaknetServer::sendData(const asio::ip::udp::endpoint &endpoint, const std::span<uint8_t> buffer) {
-        socket4->send_to(asio::buffer(buffer.data(), buffer.size()),
-                         endpoint);
+    void RaknetServer::sendData(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint,
+                                const std::span<uint8_t> buffer) {
+        RaknetSocket &socket = shard.socketFor(endpoint);
+#ifdef __linux__
+        std::lock_guard lock(socket.sendMutex);
+        if (!socket.sendBatchSlots->queue(endpoint, buffer)) {
+            socket.sendBatchSlots->flush(socket.socket->native_handle());
+            if (!socket.sendBatchSlots->queue(endpoint, buffer)) {
+                socket.socket->send_to(asio::buffer(buffer.data(), buffer.size()), endpoint);
+            }
+        }
+#else
+        socket.socket->send_to(asio::buffer(buffer.data(), buffer.size()),
+                               endpoint);
+#endif
     }
 
-    void RaknetServer::startReceive(asio::ip::udp::socket &socket) {
-        socket.async_receive_from(
-            asio::buffer(receiveBuffer),
-            remoteEndpoint,
-            [&socket, this](const asio::error_code &error, const size_t bytesReceived) {
+    void RaknetServer::flushSendBatch(RaknetShard &shard) {
+#ifdef __linux__
+        for (RaknetSocket *socket: {shard.socket4.get(), shard.socket6.get()}) {
+            if (!socket) {
+                continue;
+            }
+            std::lock_guard lock(socket->sendMutex);
+            if (!socket->sendBatchSlots->isEmpty()) {
+                socket->sendBatchSlots->flush(socket->socket->native_handle());
+            }
+        }
+#else
+        (void) shard;
+#endif
+    }
+
+    void RaknetServer::startReceive(RaknetShard &shard, RaknetSocket &socket) {
+#ifdef __linux__
+        socket.socket->async_wait(
+            asio::ip::udp::socket::wait_read,
+            [&shard, &socket, this](const asio::error_code &error) {
+                if (error == asio::error::operation_aborted) {
+                    return;
+                }
+
+                if (!error) {
+                    receiveBatch(shard, socket);
+                }
+
+                startReceive(shard, socket);
+            });
+#else
+        socket.socket->async_receive_from(
+            asio::buffer(socket.receiveBuffer),
+            socket.remoteEndpoint,
+            [&shard, &socket, this](const asio::error_code &error, const size_t bytesReceived) {
                 if (!error && bytesReceived > 0) {
-                    const std::span data(receiveBuffer.data(), bytesReceived);
-                    onMessage(remoteEndpoint, data);
+                    const std::span data(socket.receiveBuffer.data(), bytesReceived);
+                    onMessage(shard, socket.remoteEndpoint, data);
                 }
 
-                startReceive(socket);
+                startReceive(shard, socket);
             });
+#endif
+    }
+
+#ifdef __linux__
+    void RaknetServer::receiveBatch(RaknetShard &shard, RaknetSocket &socket) {
+        // cap the batches per wakeup, so one busy socket can't starve the other handlers on the io context
+        for (size_t batch = 0; batch < RECEIVE_MAX_BATCHES_PER_WAKEUP; batch++) {
+            const size_t count = socket.receiveBatchSlots->receive(socket.socket->native_handle());
+
+            for (size_t i = 0; i < count; i++) {
+                const std::span<uint8_t> data = socket.receiveBatchSlots->data(i);
+                if (data.empty() || socket.receiveBatchSlots->isTruncated(i)) {
+                    continue;
+                }
+                onMessage(shard, socket.receiveBatchSlots->endpoint(i), data);
+            }
+
+            if (count < RECEIVE_BATCH_SIZE) {
+                break;
+            }
+        }
+
+        // acks and replies of the whole wakeup go out together
+        flushSendBatch(shard);
     }
+#endif
 
-    void RaknetServer::onMessage(const asio::ip::udp::endpoint &endpoint, const std::span<uint8_t> data) {
+    void RaknetServer::onMessage(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint,
+                                 const std::span<uint8_t> data) {
         binary::Cursor cursor(data);
         const uint8_t packetId = cursor.readUint8();
 
         if (packetId & 0x80) {
-            handleOnline(endpoint, cursor);
+            handleOnline(shard, endpoint, cursor);
         } else {
-            handleOffline(endpoint, packetId, cursor);
+            handleOffline(shard, endpoint, packetId, cursor);
         }
     }
 
-    void RaknetServer::handleOnline(const asio::ip::udp::endpoint &endpoint,
+    void RaknetServer::handleOnline(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint,
                                     binary::Cursor &cursor) {
         cursor.reset();
         const uint8_t firstByte = cursor.readUint8();
         
-        std::lock_guard lock(connectionsMutex);
-        const auto it = connections.find(endpointToString(endpoint));
-        if (it == connections.end()) {
+        std::lock_guard lock(shard.connectionsMutex);
+        ServerConnection *found = shard.connections.find(EndpointKey::fromEndpoint(endpoint));
+        if (!found || found->closed.load(std::memory_order_acquire)) {
             return;
         }
-        ServerConnection &connection = it->second;
+        ServerConnection &connection = *found;
         connection.incomingLastActivity = std::chrono::steady_clock::now();
 
         const uint8_t mask = firstByte & ONLINE_DATAGRAM_BIT_MASK;
@@ -169,8 +343,8 @@ namespace jerv::raknet {
         }
     }
 
-    void RaknetServer::handleOffline(const asio::ip::udp::endpoint &endpoint, const uint8_t packetId,
-                                     binary::Cursor &cursor) {
+    void RaknetServer::handleOffline(RaknetShard &shard, const asio::ip::udp::endpoint &endpoint,
+                                     const uint8_t packetId, binary::Cursor &cursor) {
         switch (static_cast<RaknetPacketId>(packetId)) {
             case RaknetPacketId::UnconnectPing: {
                 UnconnectPingPacket unconnectPingPacket;
@@ -182,7 +356,7 @@ namespace jerv::raknet {
                 unconnectPongPacket.motd = "MCPE;JERVER;975;1.0.0;100;200;" + std::to_string(serverGuid) +
                                            ";JERVER;Survival;1;";
 
-                sendPacketOffline<34 + 69>(endpoint, unconnectPongPacket);
+                sendPacketOffline<34 + 69>(shard, endpoint, unconnectPongPacket);
                 break;
             }
             case RaknetPacketId::OpenConnectionRequest1: {
@@ -196,7 +370,7 @@ namespace jerv::raknet {
                 const size_t Mtu = cursor.buffer().size() + UDP_HEADER_SIZE;
                 connectionReply1.mtuSize = Mtu > IDEAL_MAX_MTU_SIZE ? IDEAL_MAX_MTU_SIZE : Mtu;
 
-                sendPacketOffline<31>(endpoint, connectionReply1);
+                sendPacketOffline<31>(shard, endpoint, connectionReply1);
                 break;
             }
             case RaknetPacketId::OpenConnectionRequest2: {
@@ -205,22 +379,20 @@ namespace jerv::raknet {
 
                 OpenConnectionReply2 connectionReply2;
                 connectionReply2.serverGuid = serverGuid;
-                connectionReply2.clientAddress = {
-                    .family = static_cast<uint8_t>(endpoint.protocol().family() == 2 ? 4 : 6),
-                    .ip = endpoint.address().to_v4().to_uint(),
-                    .port = endpoint.port()
-                };
+                connectionReply2.clientAddress = toAddress(endpoint);
 
-                sendPacketOffline<34>(endpoint, connectionReply2);
+                // v6 addresses take 22 more bytes than v4 ones
+                sendPacketOffline<34 + 22>(shard, endpoint, connectionReply2);
 
                 {
-                    std::lock_guard lock(connectionsMutex);
-                    connections.try_emplace(
-                        endpointToString(endpoint),
+                    std::lock_guard lock(shard.connectionsMutex);
+                    shard.connections.tryEmplace(
+                        EndpointKey::fromEndpoint(endpoint),
                         endpoint,
-                        socket4.get(),
+                        &shard,
                         connectionRequest2.mtuSize,
-                        connectionRequest2.clientGuid
+                        connectionRequest2.clientGuid,
+                        congestionControllerFactory(connectionRequest2.mtuSize - UDP_HEADER_SIZE)
                     );
                 }
                 break;
@@ -319,7 +491,7 @@ namespace jerv::raknet {
             }
         }
 
-        sendData(connection.endpoint, buffer);
+        sendData(*connection.shard, connection.endpoint, buffer);
     }
 
     void RaknetServer::handleCapsule(ServerConnection &connection, binary::Cursor &cursor) {
@@ -363,20 +535,40 @@ namespace jerv::raknet {
     }
 
     void RaknetServer::handleFragment(ServerConnection &connection, const FrameCapsule &capsule) {
-        auto &meta = connection.incomingFragmentRebuildTable[capsule.fragment.id];
-        meta.set(capsule.fragment.index, capsule.body);
+        auto &table = connection.incomingFragmentRebuildTable;
+        auto it = table.find(capsule.fragment.id);
+        if (it == table.end()) {
+            if (table.size() >= MAX_INCOMING_FRAGMENTED_PACKETS) {
+                JERV_LOG_DEBUG("dropping fragmented packet {}, too many are being rebuilt", capsule.fragment.id);
+                return;
+            }
+            it = table.try_emplace(capsule.fragment.id).first;
+        }
 
-        if (meta.length() >= capsule.fragment.length) {
+        FragmentMeta &meta = it->second;
+        const size_t before = meta.size();
+        const bool accepted = meta.set(capsule.fragment, capsule.body, connection.mtu,
+                                       MAX_INCOMING_FRAGMENT_BYTES - connection.incomingFragmentBytes,
+                                       connection.incomingLastActivity);
+        connection.incomingFragmentBytes += meta.size() - before;
+
+        if (!accepted) {
+            JERV_LOG_DEBUG("dropping malformed or oversized fragmented packet {}", capsule.fragment.id);
+            connection.incomingFragmentBytes -= meta.size();
+            table.erase(it);
+            return;
+        }
+
+        if (meta.isComplete()) {
+            connection.incomingFragmentBytes -= meta.size();
             auto rebuilt = meta.build();
-            connection.incomingFragmentRebuildTable.erase(capsule.fragment.id);
+            table.erase(it);
 
             handleFrame(connection, rebuilt);
         }
     }
 
     void RaknetServer::handleAck(ServerConnection &connection, binary::Cursor &cursor) {
-        std::lock_guard lock(connection.outgoingMutex);
-
         // skip packet id
         cursor.setPointer(1);
         uint16_t rangeCount = cursor.readUint16();
@@ -389,19 +581,32 @@ namespace jerv::raknet {
                 max = cursor.readUint24<true>();
             }
 
+            // only the last window of ids can still be in flight
+            if (max - min >= connection.outgoingUnacknowledgedCache.capacity()) {
+                min = max - connection.outgoingUnacknowledgedCache.capacity() + 1;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
             for (uint32_t j = min; j <= max; ++j) {
-                auto it = connection.outgoingUnacknowledgedCache.find(j);
-                if (it != connection.outgoingUnacknowledgedCache.end()) {
-                    connection.outgoingUnacknowledgedReliableCapsules -= it->second.size();
-                    connection.outgoingUnacknowledgedCache.erase(it);
+                if (auto *entry = connection.outgoingUnacknowledgedCache.find(j)) {
+                    // an ack of a resent datagram could belong to either send, so only take samples of first sends
+                    if (!entry->retransmitted) {
+                        connection.rtt.addSample(now - entry->sentTime);
+                    }
+                    const size_t size = UnacknowledgedRing::datagramSize(*entry);
+                    connection.outgoingBytesInFlight -= size;
+                    connection.outgoingDatagramsInFlight--;
+                    connection.congestion->onAcknowledged(size, entry->sentTime, now);
+                    UnacknowledgedRing::reset(*entry);
                 }
             }
         }
+
+        // the acknowledged bytes opened up the window for queued capsules
+        processQueue(connection);
     }
 
     void RaknetServer::handleNack(ServerConnection &connection, binary::Cursor &cursor) {
-        std::lock_guard lock(connection.outgoingMutex);
-
         // skip packet id
         cursor.setPointer(1);
         uint16_t rangeCount = cursor.readUint16();
@@ -414,13 +619,17 @@ namespace jerv::raknet {
                 max = cursor.readUint24<true>();
             }
 
+            if (max - min >= connection.outgoingUnacknowledgedCache.capacity()) {
+                min = max - connection.outgoingUnacknowledgedCache.capacity() + 1;
+            }
+
+            const auto now = std::chrono::steady_clock::now();
             for (int32_t j = max; j >= static_cast<int32_t>(min); --j) {
-                auto it = connection.outgoingUnacknowledgedCache.find(j);
-                if (it != connection.outgoingUnacknowledgedCache.end()) {
-                    for (auto &capsuleIt: std::ranges::reverse_view(it->second)) {
-                        connection.outgoingToSendStack.reverseEnqueue(capsuleIt);
-                    }
-                    connection.outgoingUnacknowledgedCache.erase(it);
+                if (auto *entry = connection.outgoingUnacknowledgedCache.find(j)) {
+                    connection.outgoingDatagramsLost++;
+                    connection.congestion->onLost(UnacknowledgedRing::datagramSize(*entry), entry->sentTime, now);
+                    // a resend held back by an occupied slot goes out on the resend timer once it times out
+                    resendUnacknowledged(connection, *entry);
                 }
             }
         }
@@ -442,6 +651,22 @@ namespace jerv::raknet {
                 sendPacketOnline(connection, connectedPong, Reliability::Unreliable);
                 break;
             }
+            case RaknetPacketId::ConnectedPong: {
+                ConnectedPongPacket connectedPong;
+                connectedPong.deserialize(cursor);
+
+                // echoes the time of our own ping, compared in milliseconds first so a forged value that reads as
+                // negative or lies in the future can't overflow the conversion or poison the estimate
+                const auto now = std::chrono::steady_clock::now();
+                const auto nowMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now.time_since_epoch()).count();
+                const auto echoed = static_cast<int64_t>(connectedPong.timeSinceStartClient);
+                if (echoed < 0 || echoed > nowMilliseconds) {
+                    break;
+                }
+                connection.rtt.addSample(now - std::chrono::steady_clock::time_point(std::chrono::milliseconds(echoed)));
+                break;
+            }
             case RaknetPacketId::ConnectionRequest: {
                 ConnectionRequestPacket connectionRequest;
                 connectionRequest.deserialize(cursor);
@@ -452,11 +677,7 @@ namespace jerv::raknet {
                 }
 
                 ConnectionRequestAcceptedPacket connectionRequestAccepted;
-                connectionRequestAccepted.clientAddress = {
-                    .family = static_cast<uint8_t>(connection.endpoint.protocol().family() == 2 ? 4 : 6),
-                    .ip = connection.endpoint.address().to_v4().to_uint(),
-                    .port = connection.endpoint.port()
-                };
+                connectionRequestAccepted.clientAddress = toAddress(connection.endpoint);
                 connectionRequestAccepted.systemIndex = 0;
                 connectionRequestAccepted.pingTime = connectionRequest.requestTimestamp;
                 connectionRequestAccepted.pongTime = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -492,7 +713,87 @@ namespace jerv::raknet {
 
     void RaknetServer::sendFrame(ServerConnection &connection, const std::span<uint8_t> data,
                                  const Reliability reliability) {
-        std::lock_guard lock(connection.outgoingMutex);
+        enqueueFrame(connection, data, reliability);
+
+        processQueue(connection);
+        detachQueued(connection);
+        flushSendBatch(*connection.shard);
+    }
+
+    bool RaknetServer::queueFrame(ServerConnection &connection, const std::span<const uint8_t> data,
+                                  const Reliability reliability) {
+        OutgoingFrame *frame = connection.outgoingHandoff.claim();
+        if (!frame) {
+            return false;
+        }
+        frame->bytes.assign(data.begin(), data.end());
+        frame->payload.reset();
+        frame->reliability = reliability;
+        connection.outgoingHandoff.publish();
+
+        scheduleHandoff(connection);
+        return true;
+    }
+
+    bool RaknetServer::queueFrame(ServerConnection &connection, std::shared_ptr<PreparedPayload> payload,
+                                  const Reliability reliability) {
+        OutgoingFrame *frame = connection.outgoingHandoff.claim();
+        if (!frame) {
+            return false;
+        }
+        frame->bytes.clear();
+        frame->payload = std::move(payload);
+        frame->reliability = reliability;
+        connection.outgoingHandoff.publish();
+
+        scheduleHandoff(connection);
+        return true;
+    }
+
+    void RaknetServer::scheduleHandoff(ServerConnection &connection) {
+        // pairs with the fence in drainHandoff, either the drain sees the published frame or this sees the cleared flag
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (connection.outgoingHandoffScheduled.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        asio::post(connection.shard->ioContext, [this, connection = connection.shared_from_this()] {
+            drainHandoff(*connection);
+        });
+    }
+
+    void RaknetServer::drainHandoff(ServerConnection &connection) {
+        connection.outgoingHandoffScheduled.store(false, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto &handoff = connection.outgoingHandoff;
+        const size_t count = handoff.readable();
+        if (count == 0) {
+            return;
+        }
+
+        if (!connection.closed.load(std::memory_order_acquire)) {
+            // everything handed over since the last pass is packed into as few datagrams as possible
+            for (size_t i = 0; i < count; i++) {
+                OutgoingFrame &frame = handoff.peek(i);
+                enqueueFrame(connection, frame.body(), static_cast<Reliability>(frame.reliability), frame.payload);
+            }
+            processQueue(connection);
+            detachQueued(connection);
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            OutgoingFrame &frame = handoff.peek(i);
+            frame.payload.reset();
+            if (frame.bytes.capacity() > OUTGOING_HANDOFF_RETAINED_CAPACITY) {
+                std::vector<uint8_t>().swap(frame.bytes);
+            }
+        }
+        handoff.pop(count);
+        flushSendBatch(*connection.shard);
+    }
+
+    void RaknetServer::enqueueFrame(ServerConnection &connection, const std::span<uint8_t> data,
+                                    const Reliability reliability, const std::shared_ptr<PreparedPayload> &payload) {
 
         if (!connection.outgoingOrderChannels.contains(connection.outgoingChannelIndex)) {
             connection.outgoingOrderChannels[connection.outgoingChannelIndex] = 0;
@@ -517,54 +818,57 @@ namespace jerv::raknet {
             const size_t fragmentCount = (data.size() + chunkSize - 1) / chunkSize;
             const uint16_t id = connection.outgoingNextFragmentId++;
 
-            std::vector<std::span<const uint8_t> > chunks;
-
-            size_t offset = 0;
-            while (offset < data.size()) {
-                size_t remaining = data.size() - offset;
-                const size_t currentChunkSize = std::min(remaining, chunkSize);
-                chunks.emplace_back(data.subspan(offset, currentChunkSize));
-                offset += currentChunkSize;
-            }
-
             uint32_t index = 0;
-
-            for (const auto &chunk: chunks) {
+            for (size_t offset = 0; offset < data.size(); offset += chunkSize) {
                 FrameCapsule fragMeta = meta;
                 const FragmentInfo fragInfo = {id, index, static_cast<uint32_t>(fragmentCount)};
                 fragMeta.hasFragment = true;
                 fragMeta.fragment = fragInfo;
-                fragMeta.body = std::span(const_cast<uint8_t *>(chunk.data()), chunk.size());
+                fragMeta.body = data.subspan(offset, std::min(data.size() - offset, chunkSize));
                 fragMeta.reliableIndex = connection.outgoingReliableIndex++;
 
-                sendCapsule(connection, fragMeta, reliability);
+                sendCapsule(connection, fragMeta, reliability, payload);
                 index++;
             }
-            // TODO: Have this here, bcs buffer die from jerv.send. Find a better way to handle it and save performance
-            processQueue(connection);
             return;
         }
 
         meta.reliableIndex = connection.outgoingReliableIndex++;
         meta.body = std::span(data.data(), data.size());
-        sendCapsule(connection, meta, reliability);
-
-        // TODO: Have this here, bcs buffer die from jerv.send. Find a better way to handle it and save performance
-        processQueue(connection);
+        sendCapsule(connection, meta, reliability, payload);
     }
 
     void RaknetServer::sendCapsule(ServerConnection &connection, const FrameCapsule &frameCapsule,
-                                   const Reliability reliability) {
+                                   const Reliability reliability, const std::shared_ptr<PreparedPayload> &payload) {
         CapsuleCache cache;
         cache.frame = frameCapsule;
         cache.reliability = reliability;
-        connection.outgoingToSendStack.enqueue(cache);
+        cache.payload = payload;
+        connection.outgoingToSendStack.enqueueGrowing(std::move(cache));
+    }
+
+    void RaknetServer::detachQueued(ServerConnection &connection) {
+        // whatever the congestion window held back still points into the buffer of the caller, which is gone after
+        // sendFrame returns or the handoff slot is reused
+        connection.outgoingToSendStack.forEach([](CapsuleCache &capsule) {
+            capsule.detach();
+        });
+    }
+
+    bool RaknetServer::canSendQueued(ServerConnection &connection) const {
+        const size_t pending = connection.outgoingBufferCursor;
+        // the next datagram takes the slot of the next frame set id, which an unacknowledged one can still hold
+        return connection.outgoingDatagramsInFlight < MAX_DATAGRAMS_IN_FLIGHT &&
+               !connection.outgoingUnacknowledgedCache.slot(connection.outgoingFrameSetId).inUse &&
+               connection.outgoingBytesInFlight + pending < connection.congestion->congestionWindow() &&
+               connection.pacer.canSend(pending);
     }
 
     void RaknetServer::processQueue(ServerConnection &connection) {
-        std::lock_guard lock(connection.outgoingMutex);
-        while (!connection.outgoingToSendStack.isEmpty() &&
-               connection.outgoingUnacknowledgedReliableCapsules < connection.unacknowledgedWindowSize) {
+        connection.pacer.refill(connection.congestion->congestionWindow(), connection.rtt.smoothed(),
+                                std::chrono::steady_clock::now());
+
+        while (!connection.outgoingToSendStack.isEmpty() && canSendQueued(connection)) {
             auto capsule = connection.outgoingToSendStack.dequeue();
 
             size_t availableSize = connection.outgoingMtu - connection.outgoingBufferCursor;
@@ -572,11 +876,9 @@ namespace jerv::raknet {
                 createCurrentConnectionBuffer(connection);
             }
 
-            if (capsule.reliability != static_cast<uint8_t>(Reliability::Unreliable) &&
-                capsule.reliability != static_cast<uint8_t>(Reliability::UnreliableSequenced)) {
-                connection.outgoingUnacknowledgedStack.push_back(capsule);
-                connection.outgoingUnacknowledgedReliableCapsules++;
-            }
+            const bool isReliable = capsule.reliability != static_cast<uint8_t>(Reliability::Unreliable) &&
+                                    capsule.reliability != static_cast<uint8_t>(Reliability::UnreliableSequenced);
+            const size_t capsuleStart = connection.outgoingBufferCursor;
 
             binary::Cursor cursor(connection.outgoingBuffer);
             cursor.setPointer(connection.outgoingBufferCursor);
@@ -614,37 +916,182 @@ namespace jerv::raknet {
             std::memcpy(connection.outgoingBuffer.data() + connection.outgoingBufferCursor,
                         capsule.frame.body.data(), capsule.frame.body.size());
             connection.outgoingBufferCursor += capsule.frame.body.size();
+
+            if (isReliable) {
+                // keep the serialized capsule, the body may point into a buffer of the caller that is gone on resend
+                auto &pending = connection.outgoingUnacknowledgedPending;
+                pending.capsules.insert(pending.capsules.end(),
+                                        connection.outgoingBuffer.begin() + capsuleStart,
+                                        connection.outgoingBuffer.begin() + connection.outgoingBufferCursor);
+                pending.capsuleCount++;
+            }
         }
 
         if (connection.outgoingBufferCursor > 4) {
             createCurrentConnectionBuffer(connection);
         }
+        connection.publishCongestionStatistics();
     }
 
     void RaknetServer::createCurrentConnectionBuffer(ServerConnection &connection) {
-        std::lock_guard lock(connection.outgoingMutex);
-
         if (connection.outgoingBufferCursor <= 4) return;
 
-        connection.outgoingBuffer[0] = VALID_DATAGRAM_BIT;
-        connection.outgoingUnacknowledgedCache[connection.outgoingFrameSetId] = std::move(
-            connection.outgoingUnacknowledgedStack);
-        connection.outgoingUnacknowledgedStack.clear();
+        const uint32_t frameSetId = connection.outgoingFrameSetId++;
 
+        connection.outgoingBuffer[0] = VALID_DATAGRAM_BIT;
         binary::Cursor cursor(connection.outgoingBuffer);
         cursor.setPointer(1);
-        cursor.writeUint24<true>(connection.outgoingFrameSetId++);
-        sendData(connection.endpoint, std::span(connection.outgoingBuffer.data(), connection.outgoingBufferCursor));
+        cursor.writeUint24<true>(frameSetId);
+        sendData(*connection.shard, connection.endpoint,
+                 std::span(connection.outgoingBuffer.data(), connection.outgoingBufferCursor));
+        connection.pacer.onSent(connection.outgoingBufferCursor);
+        connection.outgoingDatagramsSent++;
         connection.outgoingBufferCursor = 4;
+
+        auto &pending = connection.outgoingUnacknowledgedPending;
+        if (pending.capsuleCount > 0) {
+            pending.frameSetId = frameSetId & UnacknowledgedRing::FRAME_SET_ID_MASK;
+            pending.inUse = true;
+            pending.retransmitted = false;
+            pending.sentTime = std::chrono::steady_clock::now();
+            const size_t size = UnacknowledgedRing::datagramSize(pending);
+            if (storeUnacknowledged(connection, pending)) {
+                connection.outgoingBytesInFlight += size;
+                connection.outgoingDatagramsInFlight++;
+            } else {
+                // canSendQueued keeps the slot free, so this only drops capsules if that check was skipped
+                JERV_LOG_WARN("unacknowledged slot of datagram {} is still in use, its capsules will not be resent",
+                              frameSetId);
+                UnacknowledgedRing::reset(pending);
+            }
+        }
     }
 
-    void RaknetServer::disconnectClient(ServerConnection &connection) {
-        std::lock_guard lock(connectionsMutex);
-        connections.erase(endpointToString(connection.endpoint));
+    bool RaknetServer::storeUnacknowledged(ServerConnection &connection, UnacknowledgedRing::Entry &entry) {
+        auto &slot = connection.outgoingUnacknowledgedCache.slot(entry.frameSetId);
+        if (slot.inUse) {
+            return false;
+        }
+        std::swap(slot, entry);
+        UnacknowledgedRing::reset(entry);
+        return true;
+    }
+
+    void RaknetServer::sendUnacknowledged(ServerConnection &connection, UnacknowledgedRing::Entry &entry) {
+        const uint32_t frameSetId = connection.outgoingFrameSetId++;
+
+        binary::Cursor cursor(connection.outgoingResendBuffer);
+        cursor.writeUint8(VALID_DATAGRAM_BIT);
+        cursor.writeUint24<true>(frameSetId);
+        cursor.writeSliceSpan(entry.capsules);
+        sendData(*connection.shard, connection.endpoint, cursor.getProcessedBytes());
+        connection.pacer.onSent(cursor.pointer());
+        connection.outgoingDatagramsSent++;
+
+        entry.frameSetId = frameSetId & UnacknowledgedRing::FRAME_SET_ID_MASK;
+        entry.retransmitted = true;
+        entry.sentTime = std::chrono::steady_clock::now();
+    }
+
+    bool RaknetServer::resendUnacknowledged(ServerConnection &connection, UnacknowledgedRing::Entry &entry) {
+        // the resend takes the next frame set id, hold it back while another datagram in flight still owns that slot
+        const auto &next = connection.outgoingUnacknowledgedCache.slot(connection.outgoingFrameSetId);
+        if (next.inUse && &next != &entry) {
+            return false;
+        }
+
+        auto &scratch = connection.outgoingResendScratch;
+        std::swap(scratch, entry);
+        sendUnacknowledged(connection, scratch);
+        storeUnacknowledged(connection, scratch);
+        return true;
+    }
+
+    void RaknetServer::startResendTimer(RaknetShard &shard) {
+        shard.resendTimer.expires_after(RESEND_TIMER_INTERVAL);
+        shard.resendTimer.async_wait([&shard, this](const asio::error_code &error) {
+            if (error == asio::error::operation_aborted) {
+                return;
+            }
+
+            {
+                std::lock_guard lock(shard.connectionsMutex);
+                std::vector<EndpointKey> closed;
+                shard.connections.forEach([this, &closed](ServerConnection &connection) {
+                    if (connection.closed.load(std::memory_order_acquire)) {
+                        closed.push_back(EndpointKey::fromEndpoint(connection.endpoint));
+                        return;
+                    }
+                    updateConnection(connection);
+                });
+                for (const EndpointKey &key: closed) {
+                    shard.connections.erase(key);
+                }
+            }
+            flushSendBatch(shard);
+
+            startResendTimer(shard);
+        });
+    }
+
+    void RaknetServer::updateConnection(ServerConnection &connection) {
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now - connection.outgoingLastPing >= CONNECTED_PING_INTERVAL) {
+            connection.outgoingLastPing = now;
+
+            ConnectedPingPacket connectedPing;
+            connectedPing.timeSinceStart = std::chrono::duration_cast<std::chrono::milliseconds>(
+                now.time_since_epoch()
+            ).count();
+            sendPacketOnline(connection, connectedPing, Reliability::Unreliable);
+        }
+
+        // a fragmented packet whose missing fragments never come would hold its buffer for the whole connection
+        std::erase_if(connection.incomingFragmentRebuildTable, [&connection, now](const auto &entry) {
+            if (now - entry.second.lastUpdate() < INCOMING_FRAGMENT_TIMEOUT) {
+                return false;
+            }
+            connection.incomingFragmentBytes -= entry.second.size();
+            return true;
+        });
+
+        auto &cache = connection.outgoingUnacknowledgedCache;
+        const uint32_t newest = connection.outgoingFrameSetId;
+        if (newest - connection.outgoingOldestUnacknowledged > cache.capacity()) {
+            connection.outgoingOldestUnacknowledged = newest - cache.capacity();
+        }
+
+        const auto timeout = connection.rtt.retransmissionTimeout();
+        bool timedOut = false;
+
+        for (uint32_t id = connection.outgoingOldestUnacknowledged; id != newest; id++) {
+            auto *entry = cache.find(id);
+            if (!entry) {
+                if (id == connection.outgoingOldestUnacknowledged) {
+                    connection.outgoingOldestUnacknowledged++;
+                }
+                continue;
+            }
+
+            if (now - entry->sentTime >= timeout && resendUnacknowledged(connection, *entry)) {
+                connection.outgoingDatagramsLost++;
+                timedOut = true;
+            }
+        }
+
+        if (timedOut) {
+            connection.rtt.backoff();
+            connection.congestion->onRetransmissionTimeout(now);
+        }
+
+        // capsules held back by the congestion window or the pacer go out as acks and tokens come in
+        processQueue(connection);
     }
 
-    std::string RaknetServer::endpointToString(const asio::ip::udp::endpoint &endpoint) {
-        // TODO: use client guid
-        return endpoint.address().to_string() + "#" + std::to_string(endpoint.port());
+    void RaknetServer::disconnectClient(ServerConnection &connection) {
+        // erasing here would free the connection under the frame handler that is still using it, and the
+        // network thread already holds connectionsMutex when it gets here
+        connection.closed.store(true, std::memory_order_release);
     }
 }
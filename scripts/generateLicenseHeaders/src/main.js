@@ -33,9 +33,11 @@ const __dirname = dirname(__filename);
 
 const jervPackagesPath = join("../../packages");
 const jervAppSrcPath = join("../../app/src");
+const jervBenchPath = join("../../bench");
 
 recursiveReadFolder(jervPackagesPath);
 recursiveReadFolder(jervAppSrcPath);
+recursiveReadFolder(jervBenchPath);
 
 /**
  * @param {import("node:fs").PathLike} folderPath 